@@ -5,3 +5,8 @@ if (${HAVE_VTK_ZLIB})
                               LIBRARIES "${ZLIB_LIBRARIES}"
                               INCLUDE_DIRS "${ZLIB_INCLUDE_DIRS}")
 endif (${HAVE_VTK_ZLIB})
+
+find_package(Threads)
+if (Threads_FOUND)
+  dune_register_package_flags(LIBRARIES Threads::Threads)
+endif (Threads_FOUND)
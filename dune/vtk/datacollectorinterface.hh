@@ -1,10 +1,28 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include <dune/common/exceptions.hh>
+#include <dune/common/std/type_traits.hh>
+#include <dune/vtk/utility/chunkbuffer.hh>
+#include <dune/vtk/utility/indexedvalues.hh>
+#include <dune/vtk/utility/threadpool.hh>
+
 namespace Dune
 {
+  namespace Impl
+  {
+    // A local function with `evaluate(xi, ncomps, T* values)`, e.g. \ref TypedVtkLocalFunction
+    template <class LocalFunction, class LocalCoordinate, class T>
+    using EvaluateDirect = decltype(std::declval<LocalFunction const&>().evaluate(
+      std::declval<LocalCoordinate const&>(), 0, std::declval<T*>()));
+
+  } // end namespace Impl
+
   /// Base class for data collectors in a CRTP style.
   /**
    * \tparam GridView   Model of Dune::GridView
@@ -33,9 +51,37 @@ namespace Dune
     /// Update the DataCollector on the current GridView
     void update ()
     {
+      elementSeeds_.clear();
+      if (pool_ && pool_->size() > 1) {
+        for (auto const& e : elements(gridView_, partition))
+          elementSeeds_.push_back(e.seed());
+      }
       asDerived().updateImpl();
     }
 
+    /// \brief Collect the points, cells and data with the threads of `pool`
+    /**
+     * The elements are split into contiguous chunks of the traversal order that are processed
+     * in parallel, each with its own copy of the local functions. Values at points shared by
+     * several elements are written by a fixed owner element, thus the result does not depend on
+     * the number of threads. The grid must allow concurrent read access, i.e., concurrent
+     * evaluation of geometries, index sets and entity seeds. Takes effect with the next
+     * \ref update. A nullptr disables the threaded collection.
+     *
+     * The data of functions whose local function can not be cloned, see
+     * \ref VtkLocalFunctionInterface::cloneable, is collected with a single thread.
+     **/
+    void setThreadPool (Vtk::ThreadPool* pool)
+    {
+      pool_ = pool;
+    }
+
+    /// Return the GridView the data is collected on
+    GridView const& gridView () const
+    {
+      return gridView_;
+    }
+
     /// Return the number of ghost elements
     int ghostLevel () const
     {
@@ -95,6 +141,226 @@ namespace Dune
       return asDerived().template cellDataImpl<T>(fct);
     }
 
+    /// \brief Return the flat vectors of the values of all `fcts` evaluated at the points
+    /**
+     * The result is the same as \ref pointData for each function. Collectors that support it
+     * traverse the grid only once: the local functions of all `fcts` are bound to each element
+     * in turn, and the element type, reference element and local coordinates of the points are
+     * computed once for all functions. All vectors are stored at the same time.
+     **/
+    template <class T, class VtkFunction>
+    std::vector<std::vector<T>> pointDataFused (std::vector<VtkFunction> const& fcts) const
+    {
+      return asDerived().template pointDataFusedImpl<T>(fcts);
+    }
+
+    /// \brief Return the flat vectors of the values of all `fcts` evaluated at the cells
+    /// \see cellData, \see pointDataFused
+    template <class T, class VtkFunction>
+    std::vector<std::vector<T>> cellDataFused (std::vector<VtkFunction> const& fcts) const
+    {
+      return asDerived().template cellDataFusedImpl<T>(fcts);
+    }
+
+    /// \brief Pass the flat vector of point coordinates in chunks to the `sink`
+    /**
+     * The values are the same as in \ref points, but are passed to the sink, a callable
+     * `sink(T const* data, std::size_t n)`, in consecutive chunks of at most `chunkSize`
+     * values. If a collector can produce the values in output order, the full vector is
+     * never stored.
+     **/
+    template <class T, class Sink>
+    void pointsChunked (Sink&& sink, std::size_t chunkSize) const
+    {
+      asDerived().template pointsChunkedImpl<T>(sink, chunkSize);
+    }
+
+    /// \brief Pass the function values evaluated at the points in chunks to the `sink`
+    /// \see pointData, \see pointsChunked
+    template <class T, class VtkFunction, class Sink>
+    void pointDataChunked (VtkFunction const& fct, Sink&& sink, std::size_t chunkSize) const
+    {
+      asDerived().template pointDataChunkedImpl<T>(fct, sink, chunkSize);
+    }
+
+    /// \brief Pass the function values evaluated at the cells in chunks to the `sink`
+    /// \see cellData, \see pointsChunked
+    template <class T, class VtkFunction, class Sink>
+    void cellDataChunked (VtkFunction const& fct, Sink&& sink, std::size_t chunkSize) const
+    {
+      asDerived().template cellDataChunkedImpl<T>(fct, sink, chunkSize);
+    }
+
+  protected:
+    using LocalCoordinate = typename GridView::template Codim<0>::Entity::Geometry::LocalCoordinate;
+
+    // Return whether the elements are processed in parallel
+    bool threaded () const
+    {
+      return pool_ && pool_->size() > 1 && !elementSeeds_.empty();
+    }
+
+    // Number of chunks the elements are split into by \ref forEachElementChunk
+    std::size_t numElementChunks () const
+    {
+      return threaded() ? std::min(elementSeeds_.size(), 4*pool_->size()) : 1u;
+    }
+
+    /// \brief Call `f(k, forEach)` for all chunks k of elements of the partition
+    /**
+     * `forEach(g)` calls `g(i, element)` for all elements of the chunk, with `i` the position
+     * of the element in the traversal order. The chunks are processed in parallel if a thread
+     * pool is set, otherwise all elements form a single chunk. The splitting into chunks is
+     * the same in all calls until the next \ref update. If `parallel` is false, the chunks
+     * are processed one after another.
+     **/
+    template <class F>
+    void forEachElementChunk (F const& f, bool parallel = true) const
+    {
+      if (!threaded()) {
+        f(std::size_t(0), [this](auto const& g) {
+          std::size_t i = 0;
+          for (auto const& e : elements(gridView_, partition))
+            g(i++, e);
+        });
+        return;
+      }
+
+      std::size_t n = elementSeeds_.size();
+      std::size_t numChunks = numElementChunks();
+      auto chunk = [&](std::size_t k) {
+        f(k, [&](auto const& g) {
+          auto const& grid = gridView_.grid();
+          for (std::size_t i = k*n/numChunks; i < (k+1)*n/numChunks; ++i)
+            g(i, grid.entity(elementSeeds_[i]));
+        });
+      };
+
+      if (parallel)
+        pool_->parallelFor(numChunks, chunk);
+      else {
+        for (std::size_t k = 0; k < numChunks; ++k)
+          chunk(k);
+      }
+    }
+
+    // Call \ref forEachElementChunk with the local functions of the `fcts` evaluated in `f`. The
+    // chunks are processed one after another if one of the local functions can not be cloned.
+    template <class VtkFunction, class F>
+    void forEachElementChunk (std::vector<VtkFunction> const& fcts, F const& f) const
+    {
+      forEachElementChunk(f, !threaded() || cloneable(fcts));
+    }
+
+    // Evaluate all `ncomps` components of the bound `localFct` at the local coordinates `xi` in
+    // one call and store the values at `xi[k]` in `data[ncomps*points[k] + comp]`.
+    template <class T, class LocalFunction, class LocalCoordinate, class Index>
+    static void evaluatePoints (LocalFunction const& localFct, std::vector<LocalCoordinate> const& xi,
+                                std::vector<Index> const& points, int ncomps,
+                                std::vector<double>& buffer, std::vector<T>& data)
+    {
+      using Direct = Std::is_detected<Impl::EvaluateDirect, LocalFunction, LocalCoordinate, T>;
+      evaluatePoints(localFct, xi, points, ncomps, buffer, data, Direct{});
+    }
+
+    // Local functions that can evaluate in the output type write the values directly to `data`
+    template <class T, class LocalFunction, class LocalCoordinate, class Index>
+    static void evaluatePoints (LocalFunction const& localFct, std::vector<LocalCoordinate> const& xi,
+                                std::vector<Index> const& points, int ncomps,
+                                std::vector<double>& /*buffer*/, std::vector<T>& data, std::true_type)
+    {
+      for (std::size_t k = 0; k < points.size(); ++k)
+        localFct.evaluate(xi[k], ncomps, &data[ncomps*std::size_t(points[k])]);
+    }
+
+    template <class T, class LocalFunction, class LocalCoordinate, class Index>
+    static void evaluatePoints (LocalFunction const& localFct, std::vector<LocalCoordinate> const& xi,
+                                std::vector<Index> const& points, int ncomps,
+                                std::vector<double>& buffer, std::vector<T>& data, std::false_type)
+    {
+      buffer.resize(xi.size() * ncomps);
+      localFct.evaluateAll(xi, ncomps, buffer.data());
+      for (std::size_t k = 0; k < points.size(); ++k)
+        for (int comp = 0; comp < ncomps; ++comp)
+          data[ncomps*std::size_t(points[k]) + comp] = T(buffer[k*ncomps + comp]);
+    }
+
+    // Return a copy of the local function of each of the `fcts` that can be bound independently.
+    // Local functions that can not be cloned are shared with the `fcts`.
+    template <class VtkFunction>
+    static auto localFunctions (std::vector<VtkFunction> const& fcts)
+    {
+      std::vector<decltype(localFunction(std::declval<VtkFunction const&>()))> localFcts;
+      localFcts.reserve(fcts.size());
+      for (auto const& fct : fcts) {
+        auto localFct = localFunction(fct);
+        localFcts.push_back(localFct.cloneable() ? localFct.clone() : localFct);
+      }
+      return localFcts;
+    }
+
+    // Return whether the local functions of all `fcts` can be cloned
+    template <class VtkFunction>
+    static bool cloneable (std::vector<VtkFunction> const& fcts)
+    {
+      return std::all_of(fcts.begin(), fcts.end(), [](auto const& fct) {
+        return localFunction(fct).cloneable(); });
+    }
+
+    // Return a vector of `n*ncomps` values for each of the `fcts`
+    template <class T, class VtkFunction>
+    static std::vector<std::vector<T>> makeDataFused (std::uint64_t n, std::vector<VtkFunction> const& fcts)
+    {
+      std::vector<std::vector<T>> data;
+      data.reserve(fcts.size());
+      for (auto const& fct : fcts)
+        data.emplace_back(n * fct.ncomps());
+      return data;
+    }
+
+    // Bind each of the `localFcts` to the element `e` in turn and evaluate it at the local
+    // coordinates `xi`, see \ref evaluatePoints. The values of `fcts[f]` are stored in `data[f]`.
+    template <class T, class LocalFunction, class Element, class VtkFunction, class LocalCoordinate, class Index>
+    static void evaluatePointsFused (std::vector<LocalFunction>& localFcts, Element const& e,
+                                     std::vector<VtkFunction> const& fcts,
+                                     std::vector<LocalCoordinate> const& xi, std::vector<Index> const& points,
+                                     std::vector<double>& buffer, std::vector<std::vector<T>>& data)
+    {
+      for (std::size_t f = 0; f < localFcts.size(); ++f) {
+        localFcts[f].bind(e);
+        evaluatePoints(localFcts[f], xi, points, fcts[f].ncomps(), buffer, data[f]);
+        localFcts[f].unbind();
+      }
+    }
+
+    // Copy the values of the `fcts` given by \ref Vtk::IndexedValues attached to the entities of
+    // codimension `codim` with `gather(values, ncomps)`, and collect the values of all other
+    // functions with `collect(otherFcts)`. Both return the flat vectors of values.
+    template <class T, class VtkFunction, class Gather, class Collect>
+    static std::vector<std::vector<T>> collectFused (std::vector<VtkFunction> const& fcts, int codim,
+                                                     Gather const& gather, Collect const& collect)
+    {
+      std::vector<std::vector<T>> data(fcts.size());
+      std::vector<VtkFunction> otherFcts;
+      std::vector<std::size_t> positions;
+      for (std::size_t f = 0; f < fcts.size(); ++f) {
+        Vtk::IndexedValues const* values = fcts[f].indexedValues();
+        if (values && values->codim() == codim) {
+          data[f] = gather(*values, fcts[f].ncomps());
+        } else {
+          otherFcts.push_back(fcts[f]);
+          positions.push_back(f);
+        }
+      }
+
+      if (!otherFcts.empty()) {
+        auto otherData = collect(otherFcts);
+        for (std::size_t k = 0; k < positions.size(); ++k)
+          data[positions[k]] = std::move(otherData[k]);
+      }
+      return data;
+    }
+
   protected: // cast to derived type
 
     Derived& asDerived ()
@@ -121,10 +387,53 @@ namespace Dune
 
     // Evaluate `fct` in center of cell.
     template <class T, class VtkFunction>
-    std::vector<T> cellDataImpl (VtkFunction const& fct) const;
+    std::vector<T> cellDataImpl (VtkFunction const& fct) const
+    {
+      return std::move(asDerived().template cellDataFused<T>(std::vector<VtkFunction>{fct}).front());
+    }
+
+    // Evaluate the `fcts` one after another.
+    template <class T, class VtkFunction>
+    std::vector<std::vector<T>> pointDataFusedImpl (std::vector<VtkFunction> const& fcts) const
+    {
+      std::vector<std::vector<T>> data;
+      data.reserve(fcts.size());
+      for (auto const& fct : fcts)
+        data.push_back(asDerived().template pointData<T>(fct));
+      return data;
+    }
+
+    // Evaluate all `fcts` in center of cell, in one traversal of the grid. Values attached
+    // to the elements are copied.
+    template <class T, class VtkFunction>
+    std::vector<std::vector<T>> cellDataFusedImpl (std::vector<VtkFunction> const& fcts) const;
+
+    // Collect all points and pass the vector in chunks.
+    template <class T, class Sink>
+    void pointsChunkedImpl (Sink& sink, std::size_t chunkSize) const
+    {
+      Vtk::passChunks(asDerived().template points<T>(), sink, chunkSize);
+    }
+
+    // Collect all point values and pass the vector in chunks.
+    template <class T, class VtkFunction, class Sink>
+    void pointDataChunkedImpl (VtkFunction const& fct, Sink& sink, std::size_t chunkSize) const
+    {
+      Vtk::passChunks(asDerived().template pointData<T>(fct), sink, chunkSize);
+    }
+
+    // Evaluate `fct` in center of cell and pass the values in chunks. Produces the
+    // same values as \ref cellDataImpl without storing the whole vector, unless the
+    // elements are processed in parallel.
+    template <class T, class VtkFunction, class Sink>
+    void cellDataChunkedImpl (VtkFunction const& fct, Sink& sink, std::size_t chunkSize) const;
 
   protected:
     GridView gridView_;
+
+    using ElementSeed = typename GridView::Grid::template Codim<0>::EntitySeed;
+    std::vector<ElementSeed> elementSeeds_;
+    Vtk::ThreadPool* pool_ = nullptr;
   };
 
 } // end namespace Dune
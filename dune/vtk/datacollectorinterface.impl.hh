@@ -8,21 +8,74 @@ namespace Dune {
 
 template <class GV, class D, class P>
   template <class T, class VtkFunction>
-std::vector<T> DataCollectorInterface<GV,D,P>
-  ::cellDataImpl (VtkFunction const& fct) const
+std::vector<std::vector<T>> DataCollectorInterface<GV,D,P>
+  ::cellDataFusedImpl (std::vector<VtkFunction> const& fcts) const
 {
-  std::vector<T> data;
-  data.reserve(this->numCells() * fct.ncomps());
+  std::vector<std::size_t> indices;
+  auto gather = [&](Vtk::IndexedValues const& values, int ncomps)
+  {
+    if (indices.empty()) {
+      indices.reserve(this->numCells());
+      auto const& indexSet = gridView_.indexSet();
+      for (auto const& e : elements(gridView_, partition))
+        indices.push_back(indexSet.index(e));
+    }
+
+    std::vector<T> data(indices.size() * ncomps);
+    values.gather(indices, ncomps, data.data());
+    return data;
+  };
+
+  auto evaluate = [&](std::vector<VtkFunction> const& otherFcts)
+  {
+    auto data = makeDataFused<T>(this->numCells(), otherFcts);
+    forEachElementChunk(otherFcts, [&](std::size_t /*k*/, auto forEach)
+    {
+      auto localFcts = localFunctions(otherFcts);
+      std::vector<LocalCoordinate> xi(1);
+      std::vector<std::size_t> cell(1);
+      std::vector<double> buffer;
+      forEach([&](std::size_t i, auto const& e)
+      {
+        xi[0] = referenceElement<typename LocalCoordinate::value_type,dim>(e.type()).position(0,0);
+        cell[0] = i;
+        evaluatePointsFused(localFcts, e, otherFcts, xi, cell, buffer, data);
+      });
+    });
+    return data;
+  };
+
+  return collectFused<T>(fcts, 0, gather, evaluate);
+}
+
+
+template <class GV, class D, class P>
+  template <class T, class VtkFunction, class Sink>
+void DataCollectorInterface<GV,D,P>
+  ::cellDataChunkedImpl (VtkFunction const& fct, Sink& sink, std::size_t chunkSize) const
+{
+  if (threaded() || (fct.indexedValues() && fct.indexedValues()->codim() == 0)) {
+    // copy the values attached to the elements, or evaluate the function in parallel
+    Vtk::passChunks(asDerived().template cellData<T>(fct), sink, chunkSize);
+    return;
+  }
+
+  Vtk::ChunkBuffer<T,Sink> data(sink, chunkSize);
 
   auto localFct = localFunction(fct);
+  std::vector<LocalCoordinate> xi(1);
+  std::vector<std::size_t> cell(1, 0);
+  std::vector<double> buffer;
+  std::vector<T> values(fct.ncomps());
   for (auto const& e : elements(gridView_, partition)) {
     localFct.bind(e);
-    auto refElem = referenceElement<T,dim>(e.type());
-    for (int comp = 0; comp < fct.ncomps(); ++comp)
-      data.emplace_back(localFct.evaluate(comp, refElem.position(0,0)));
+    xi[0] = referenceElement<typename LocalCoordinate::value_type,dim>(e.type()).position(0,0);
+    evaluatePoints(localFct, xi, cell, fct.ncomps(), buffer, values);
+    for (T const& value : values)
+      data.push_back(value);
     localFct.unbind();
   }
-  return data;
+  data.flush();
 }
 
 } // end namespace Dune
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <numeric>
+#include <utility>
 #include "unstructureddatacollector.hh"
 
 #include <dune/grid/utility/globalindexset.hh>
@@ -25,20 +26,27 @@ public:
     : Super(gridView)
   {}
 
-  /// Collect the vertex indices
+  /// Collect the vertex indices and the owner element of each vertex
   void updateImpl ()
   {
     numPoints_ = 0;
     indexMap_.resize(gridView_.size(dim));
+    vertexIndex_.clear();
     auto const& indexSet = gridView_.indexSet();
-    for (auto const& vertex : vertices(gridView_, partition))
+    for (auto const& vertex : vertices(gridView_, partition)) {
       indexMap_[indexSet.index(vertex)] = std::int64_t(numPoints_++);
+      vertexIndex_.push_back(indexSet.index(vertex));
+    }
 
-    if (gridView_.comm().size() > 1) {
-      auto&& e = elements(gridView_, partition);
-      numCells_ = std::distance(std::begin(e), std::end(e));
-    } else {
-      numCells_ = gridView_.size(0);
+    // the last element containing a vertex writes its values, as in a sequential traversal
+    numCells_ = 0;
+    numCorners_ = 0;
+    pointOwner_.resize(numPoints_);
+    for (auto const& c : elements(gridView_, partition)) {
+      for (unsigned int j = 0; j < c.subEntities(dim); ++j)
+        pointOwner_[indexMap_[indexSet.subIndex(c,j,dim)]] = numCells_;
+      numCells_++;
+      numCorners_ += c.subEntities(dim);
     }
   }
 
@@ -52,6 +60,9 @@ public:
   template <class T>
   std::vector<T> pointsImpl () const
   {
+    if (this->threaded())
+      return pointsThreaded<T>();
+
     std::vector<T> data;
     data.reserve(numPoints_ * 3);
     for (auto const& vertex : vertices(gridView_, partition)) {
@@ -64,6 +75,27 @@ public:
     return data;
   }
 
+  /// Pass the coordinates of all grid vertices in chunks to the `sink`. With a thread pool,
+  /// the coordinates are collected in parallel first.
+  template <class T, class Sink>
+  void pointsChunkedImpl (Sink& sink, std::size_t chunkSize) const
+  {
+    if (this->threaded()) {
+      Vtk::passChunks(pointsThreaded<T>(), sink, chunkSize);
+      return;
+    }
+
+    Vtk::ChunkBuffer<T,Sink> data(sink, chunkSize);
+    for (auto const& vertex : vertices(gridView_, partition)) {
+      auto v = vertex.geometry().center();
+      for (std::size_t j = 0; j < v.size(); ++j)
+        data.push_back(T(v[j]));
+      for (std::size_t j = v.size(); j < 3u; ++j)
+        data.push_back(T(0));
+    }
+    data.flush();
+  }
+
   /// Return a vector of global unique ids of the points
   std::vector<std::uint64_t> pointIdsImpl () const
   {
@@ -84,57 +116,222 @@ public:
 
   /// Return the types, offsets and connectivity of the cells, using the same connectivity as
   /// given by the grid.
+  /**
+   * The element chunks are processed in parallel, if a thread pool is set. The first entry of
+   * each chunk in the connectivity is given by a prefix sum over the number of corners of
+   * the chunks.
+   **/
   Cells cellsImpl () const
   {
     auto const& indexSet = gridView_.indexSet();
-    auto types = indexSet.types(0);
-    int maxVertices = std::accumulate(types.begin(), types.end(), 1, [](int m, GeometryType t) {
-      auto refElem = referenceElement<double,dim>(t);
-      return std::max(m, refElem.size(dim));
-    });
+    auto chunkOffsets = cornerOffsets();
 
     Cells cells;
-    cells.connectivity.reserve(numCells_ * maxVertices);
-    cells.offsets.reserve(numCells_);
-    cells.types.reserve(numCells_);
+    cells.connectivity.resize(numCorners_);
+    cells.offsets.resize(numCells_);
+    cells.types.resize(numCells_);
+
+    this->forEachElementChunk([&](std::size_t k, auto forEach) {
+      std::int64_t old_o = chunkOffsets[k];
+      forEach([&](std::size_t i, auto const& c) {
+        Vtk::CellType cellType(c.type());
+        for (unsigned int j = 0; j < c.subEntities(dim); ++j)
+          cells.connectivity[old_o + j] = indexMap_[indexSet.subIndex(c,cellType.permutation(j),dim)];
+        cells.offsets[i] = old_o += c.subEntities(dim);
+        cells.types[i] = cellType.type();
+      });
+    });
+    return cells;
+  }
+
+  /// Return the sum of the number of corners of all cells
+  std::uint64_t connectivitySizeImpl () const
+  {
+    return numCorners_;
+  }
+
+  /// Pass the VTK cell types in chunks to the `sink`. With a thread pool, the types are
+  /// collected in parallel first, as are the offsets and the connectivity below.
+  template <class Sink>
+  void typesChunkedImpl (Sink& sink, std::size_t chunkSize) const
+  {
+    if (this->threaded()) {
+      std::vector<std::uint8_t> types(numCells_);
+      this->forEachElementChunk([&](std::size_t /*k*/, auto forEach) {
+        forEach([&](std::size_t i, auto const& c) { types[i] = Vtk::CellType{c.type()}.type(); });
+      });
+      Vtk::passChunks(types, sink, chunkSize);
+      return;
+    }
 
+    Vtk::ChunkBuffer<std::uint8_t,Sink> types(sink, chunkSize);
+    for (auto const& c : elements(gridView_, partition))
+      types.push_back(Vtk::CellType{c.type()}.type());
+    types.flush();
+  }
+
+  /// Pass the cell offsets in chunks to the `sink`
+  template <class Sink>
+  void offsetsChunkedImpl (Sink& sink, std::size_t chunkSize) const
+  {
+    if (this->threaded()) {
+      auto chunkOffsets = cornerOffsets();
+      std::vector<std::int64_t> offsets(numCells_);
+      this->forEachElementChunk([&](std::size_t k, auto forEach) {
+        std::int64_t old_o = chunkOffsets[k];
+        forEach([&](std::size_t i, auto const& c) { offsets[i] = old_o += c.subEntities(dim); });
+      });
+      Vtk::passChunks(offsets, sink, chunkSize);
+      return;
+    }
+
+    Vtk::ChunkBuffer<std::int64_t,Sink> offsets(sink, chunkSize);
     std::int64_t old_o = 0;
+    for (auto const& c : elements(gridView_, partition))
+      offsets.push_back(old_o += c.subEntities(dim));
+    offsets.flush();
+  }
+
+  /// Pass the cell connectivity in chunks to the `sink`
+  template <class Sink>
+  void connectivityChunkedImpl (Sink& sink, std::size_t chunkSize) const
+  {
+    auto const& indexSet = gridView_.indexSet();
+    if (this->threaded()) {
+      auto chunkOffsets = cornerOffsets();
+      std::vector<std::int64_t> connectivity(numCorners_);
+      this->forEachElementChunk([&](std::size_t k, auto forEach) {
+        std::int64_t old_o = chunkOffsets[k];
+        forEach([&](std::size_t /*i*/, auto const& c) {
+          Vtk::CellType cellType(c.type());
+          for (unsigned int j = 0; j < c.subEntities(dim); ++j)
+            connectivity[old_o++] = indexMap_[indexSet.subIndex(c,cellType.permutation(j),dim)];
+        });
+      });
+      Vtk::passChunks(connectivity, sink, chunkSize);
+      return;
+    }
+
+    Vtk::ChunkBuffer<std::int64_t,Sink> connectivity(sink, chunkSize);
     for (auto const& c : elements(gridView_, partition)) {
       Vtk::CellType cellType(c.type());
       for (unsigned int j = 0; j < c.subEntities(dim); ++j)
-        cells.connectivity.emplace_back(indexMap_[indexSet.subIndex(c,cellType.permutation(j),dim)]);
-      cells.offsets.push_back(old_o += c.subEntities(dim));
-      cells.types.push_back(cellType.type());
+        connectivity.push_back(indexMap_[indexSet.subIndex(c,cellType.permutation(j),dim)]);
     }
-    return cells;
+    connectivity.flush();
   }
 
   /// Evaluate the `fct` at the corners of the elements
+  /**
+   * Each vertex value is written by the last element containing the vertex, thus the result
+   * does not depend on the number of threads. All components at all vertices owned by an
+   * element are evaluated in one call.
+   **/
   template <class T, class GlobalFunction>
   std::vector<T> pointDataImpl (GlobalFunction const& fct) const
   {
-    std::vector<T> data(numPoints_ * fct.ncomps());
+    return std::move(pointDataFusedImpl<T>(std::vector<GlobalFunction>{fct}).front());
+  }
+
+  /// \brief Evaluate all `fcts` at the corners of the elements in one traversal, \see pointDataImpl
+  /**
+   * Values attached to the vertices are copied in the order of the points, without
+   * traversing the grid.
+   **/
+  template <class T, class GlobalFunction>
+  std::vector<std::vector<T>> pointDataFusedImpl (std::vector<GlobalFunction> const& fcts) const
+  {
+    auto gather = [&](Vtk::IndexedValues const& values, int ncomps) {
+      std::vector<T> data(numPoints_ * ncomps);
+      values.gather(vertexIndex_, ncomps, data.data());
+      return data;
+    };
+    auto evaluate = [&](std::vector<GlobalFunction> const& otherFcts) {
+      return this->template evaluateFused<T>(otherFcts);
+    };
+    return this->template collectFused<T>(fcts, dim, gather, evaluate);
+  }
+
+private:
+  // Evaluate all `fcts` at the vertices owned by each element
+  template <class T, class GlobalFunction>
+  std::vector<std::vector<T>> evaluateFused (std::vector<GlobalFunction> const& fcts) const
+  {
+    auto data = this->template makeDataFused<T>(numPoints_, fcts);
     auto const& indexSet = gridView_.indexSet();
-    auto localFct = localFunction(fct);
-    for (auto const& e : elements(gridView_, partition)) {
-      localFct.bind(e);
-      Vtk::CellType cellType{e.type()};
-      auto refElem = referenceElement(e.geometry());
-      for (unsigned int j = 0; j < e.subEntities(dim); ++j) {
-        std::size_t idx = fct.ncomps() * indexMap_[indexSet.subIndex(e,cellType.permutation(j),dim)];
-        for (int comp = 0; comp < fct.ncomps(); ++comp)
-          data[idx + comp] = T(localFct.evaluate(comp, refElem.position(cellType.permutation(j),dim)));
-      }
-      localFct.unbind();
+    this->forEachElementChunk(fcts, [&](std::size_t /*k*/, auto forEach) {
+      auto localFcts = this->localFunctions(fcts);
+      std::vector<LocalCoordinate> xi;
+      std::vector<std::int64_t> points;
+      std::vector<double> buffer;
+      forEach([&](std::size_t i, auto const& e) {
+        Vtk::CellType cellType{e.type()};
+        auto refElem = referenceElement(e.geometry());
+        xi.clear();
+        points.clear();
+        for (unsigned int j = 0; j < e.subEntities(dim); ++j) {
+          std::int64_t p = indexMap_[indexSet.subIndex(e,cellType.permutation(j),dim)];
+          if (pointOwner_[p] == i) {
+            xi.push_back(refElem.position(cellType.permutation(j),dim));
+            points.push_back(p);
+          }
+        }
+        if (!points.empty())
+          this->evaluatePointsFused(localFcts, e, fcts, xi, points, buffer, data);
+      });
+    });
+    return data;
+  }
+
+  // Return the position of the first corner of each element chunk in the connectivity, given
+  // by a prefix sum over the number of corners of the chunks
+  std::vector<std::int64_t> cornerOffsets () const
+  {
+    std::vector<std::int64_t> chunkOffsets(this->numElementChunks() + 1, 0);
+    if (this->threaded()) {
+      this->forEachElementChunk([&](std::size_t k, auto forEach) {
+        std::int64_t n = 0;
+        forEach([&](std::size_t /*i*/, auto const& c) { n += c.subEntities(dim); });
+        chunkOffsets[k+1] = n;
+      });
+      std::partial_sum(chunkOffsets.begin(), chunkOffsets.end(), chunkOffsets.begin());
     }
+    return chunkOffsets;
+  }
+
+  // Collect the coordinates of the vertices from the corners of their owner elements in parallel
+  template <class T>
+  std::vector<T> pointsThreaded () const
+  {
+    std::vector<T> data(numPoints_ * 3);
+    auto const& indexSet = gridView_.indexSet();
+    this->forEachElementChunk([&](std::size_t /*k*/, auto forEach) {
+      forEach([&](std::size_t i, auto const& e) {
+        auto geometry = e.geometry();
+        for (unsigned int j = 0; j < e.subEntities(dim); ++j) {
+          std::int64_t p = indexMap_[indexSet.subIndex(e,j,dim)];
+          if (pointOwner_[p] != i)
+            continue;
+          auto v = geometry.corner(j);
+          for (std::size_t d = 0; d < v.size(); ++d)
+            data[3*p + d] = T(v[d]);
+          for (std::size_t d = v.size(); d < 3u; ++d)
+            data[3*p + d] = T(0);
+        }
+      });
+    });
     return data;
   }
 
 protected:
+  using typename Super::LocalCoordinate;
   using Super::gridView_;
   std::uint64_t numPoints_ = 0;
   std::uint64_t numCells_ = 0;
+  std::uint64_t numCorners_ = 0;
   std::vector<std::int64_t> indexMap_;
+  std::vector<std::size_t> vertexIndex_; //< vertex index of each point
+  std::vector<std::size_t> pointOwner_; //< position of the element that writes the vertex values
 };
 
 } // end namespace Dune
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <utility>
+
 #include "unstructureddatacollector.hh"
 
 namespace Dune
@@ -92,28 +94,80 @@ public:
     return cells;
   }
 
+  /// The connectivity has one entry per point
+  std::uint64_t connectivitySizeImpl () const
+  {
+    return numPoints_;
+  }
+
+  /// Pass the VTK cell types in chunks to the `sink`
+  template <class Sink>
+  void typesChunkedImpl (Sink& sink, std::size_t chunkSize) const
+  {
+    Vtk::ChunkBuffer<std::uint8_t,Sink> types(sink, chunkSize);
+    for (auto const& c : elements(gridView_, partition))
+      types.push_back(Vtk::CellType{c.type()}.type());
+    types.flush();
+  }
+
+  /// Pass the cell offsets in chunks to the `sink`
+  template <class Sink>
+  void offsetsChunkedImpl (Sink& sink, std::size_t chunkSize) const
+  {
+    Vtk::ChunkBuffer<std::int64_t,Sink> offsets(sink, chunkSize);
+    std::int64_t old_o = 0;
+    for (auto const& c : elements(gridView_, partition))
+      offsets.push_back(old_o += c.subEntities(dim));
+    offsets.flush();
+  }
+
+  /// Pass the cell connectivity in chunks to the `sink`, in the same order as \ref cellsImpl
+  template <class Sink>
+  void connectivityChunkedImpl (Sink& sink, std::size_t chunkSize) const
+  {
+    Vtk::ChunkBuffer<std::int64_t,Sink> connectivity(sink, chunkSize);
+    auto const& indexSet = gridView_.indexSet();
+    for (auto const& c : elements(gridView_, partition)) {
+      Vtk::CellType cellType(c.type());
+      for (unsigned int j = 0; j < c.subEntities(dim); ++j)
+        connectivity.push_back(indexMap_[indexSet.subIndex(c,cellType.permutation(j),dim)]);
+    }
+    connectivity.flush();
+  }
+
   /// Evaluate the `fct` in the corners of each cell
   template <class T, class GlobalFunction>
   std::vector<T> pointDataImpl (GlobalFunction const& fct) const
   {
-    std::vector<T> data(numPoints_ * fct.ncomps());
+    return std::move(pointDataFusedImpl<T>(std::vector<GlobalFunction>{fct}).front());
+  }
+
+  /// Evaluate all `fcts` in the corners of each cell in one traversal
+  template <class T, class GlobalFunction>
+  std::vector<std::vector<T>> pointDataFusedImpl (std::vector<GlobalFunction> const& fcts) const
+  {
+    auto data = this->template makeDataFused<T>(numPoints_, fcts);
     auto const& indexSet = gridView_.indexSet();
-    auto localFct = localFunction(fct);
+    auto localFcts = this->localFunctions(fcts);
+    std::vector<LocalCoordinate> xi;
+    std::vector<std::int64_t> points;
+    std::vector<double> buffer;
     for (auto const& e : elements(gridView_, partition)) {
-      localFct.bind(e);
       Vtk::CellType cellType{e.type()};
       auto refElem = referenceElement(e.geometry());
+      xi.clear();
+      points.clear();
       for (unsigned int j = 0; j < e.subEntities(dim); ++j) {
-        std::size_t idx = fct.ncomps() * indexMap_[indexSet.subIndex(e, cellType.permutation(j), dim)];
-        for (int comp = 0; comp < fct.ncomps(); ++comp)
-          data[idx + comp] = T(localFct.evaluate(comp, refElem.position(cellType.permutation(j),dim)));
+        xi.push_back(refElem.position(cellType.permutation(j),dim));
+        points.push_back(indexMap_[indexSet.subIndex(e, cellType.permutation(j), dim)]);
       }
-      localFct.unbind();
+      this->evaluatePointsFused(localFcts, e, fcts, xi, points, buffer, data);
     }
     return data;
   }
 
 protected:
+  using typename Super::LocalCoordinate;
   using Super::gridView_;
   std::uint64_t numCells_ = 0;
   std::uint64_t numPoints_ = 0;
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/geometry/referenceelements.hh>
+#include <dune/vtk/utility/lagrangepoints.hh>
+#include <dune/vtk/utility/nodenumbering.hh>
+
+#include "unstructureddatacollector.hh"
+
+namespace Dune
+{
+
+/// Implementation of \ref DataCollector for Lagrange cells of arbitrary order, with continuous data.
+/**
+ * The cells are written as VTK_LAGRANGE_* cells with the equidistant Lagrange nodes of
+ * order `ORDER`. Nodes on vertices, edges, and faces are shared by all cells of the
+ * partition containing them, nodes in the interior of a cell are not shared.
+ *
+ * Supported are lines, triangles, quadrilaterals, tetrahedra, hexahedra, and prisms.
+ **/
+template <class GridView, int ORDER, class Partition>
+class LagrangeDataCollector
+    : public UnstructuredDataCollectorInterface<GridView, LagrangeDataCollector<GridView,ORDER,Partition>, Partition>
+{
+  using Self = LagrangeDataCollector;
+  using Super = UnstructuredDataCollectorInterface<GridView, Self, Partition>;
+
+  static_assert(ORDER > 0, "Order of Lagrange cells must be positive.");
+
+  using LocalCoordinate = typename GridView::template Codim<0>::Entity::Geometry::LocalCoordinate;
+
+  // The Lagrange nodes of one geometry type in VTK ordering
+  struct LocalNodes
+  {
+    std::uint8_t type;
+    std::vector<LocalCoordinate> positions;
+    std::vector<std::vector<std::pair<int, std::int64_t>>> weights; // (Dune corner, weight), nonzero only
+  };
+
+public:
+  using Super::dim;
+  using Super::partition;
+
+public:
+  LagrangeDataCollector (GridView const& gridView)
+    : Super(gridView)
+  {}
+
+  /// Construct the local nodes of all geometry types and number the shared nodes
+  void updateImpl ()
+  {
+    auto const& indexSet = gridView_.indexSet();
+    localNodes_.clear();
+    for (auto const& t : indexSet.types(0))
+      localNodes_.emplace(t, makeLocalNodes(t));
+
+    cells_ = Cells{};
+    Vtk::NodeNumbering numbering;
+    numbering.reset(gridView_.size(dim));
+    for (auto const& c : elements(gridView_, partition)) {
+      LocalNodes const& nodes = localNodes_.at(c.type());
+      auto vertexIndex = [&](int i) { return indexSet.subIndex(c, i, dim); };
+      for (auto const& w : nodes.weights)
+        cells_.connectivity.push_back(numbering.index(w, c.subEntities(dim), vertexIndex));
+      cells_.offsets.push_back(std::int64_t(cells_.connectivity.size()));
+      cells_.types.push_back(nodes.type);
+    }
+    numPoints_ = numbering.size();
+
+    // the last cell containing a node writes its values, as in a sequential traversal
+    pointOwner_.resize(numPoints_);
+    for (std::size_t i = 0, k = 0; i < cells_.offsets.size(); ++i)
+      for (; k < std::size_t(cells_.offsets[i]); ++k)
+        pointOwner_[cells_.connectivity[k]] = i;
+  }
+
+  /// Return the number of Lagrange nodes
+  std::uint64_t numPointsImpl () const
+  {
+    return numPoints_;
+  }
+
+  /// Return the coordinates of the Lagrange nodes in the order of their first appearance in
+  /// the cell connectivity
+  template <class T>
+  std::vector<T> pointsImpl () const
+  {
+    std::vector<T> data(numPoints_ * 3);
+    this->forEachElementChunk([&](std::size_t /*k*/, auto forEach) {
+      forEach([&](std::size_t i, auto const& c) {
+        LocalNodes const& nodes = localNodes_.at(c.type());
+        auto geometry = c.geometry();
+        std::size_t k = firstNode(i);
+        for (auto const& x : nodes.positions) {
+          std::int64_t p = cells_.connectivity[k++];
+          if (pointOwner_[p] != i)
+            continue;
+          auto v = geometry.global(x);
+          for (std::size_t j = 0; j < v.size(); ++j)
+            data[3*p + j] = T(v[j]);
+          for (std::size_t j = v.size(); j < 3u; ++j)
+            data[3*p + j] = T(0);
+        }
+      });
+    });
+    return data;
+  }
+
+  /// Return number of grid cells
+  std::uint64_t numCellsImpl () const
+  {
+    return cells_.types.size();
+  }
+
+  /// Return the types, offsets and connectivity of the Lagrange cells, computed in \ref updateImpl
+  Cells const& cellsImpl () const
+  {
+    return cells_;
+  }
+
+  /// Return the number of nodes of all cells
+  std::uint64_t connectivitySizeImpl () const
+  {
+    return cells_.connectivity.size();
+  }
+
+  /// Evaluate the `fct` at the Lagrange nodes
+  template <class T, class GlobalFunction>
+  std::vector<T> pointDataImpl (GlobalFunction const& fct) const
+  {
+    return std::move(pointDataFusedImpl<T>(std::vector<GlobalFunction>{fct}).front());
+  }
+
+  /// Evaluate all `fcts` at the Lagrange nodes in one traversal
+  template <class T, class GlobalFunction>
+  std::vector<std::vector<T>> pointDataFusedImpl (std::vector<GlobalFunction> const& fcts) const
+  {
+    auto data = this->template makeDataFused<T>(numPoints_, fcts);
+    this->forEachElementChunk(fcts, [&](std::size_t /*k*/, auto forEach) {
+      auto localFcts = this->localFunctions(fcts);
+      std::vector<LocalCoordinate> xi;
+      std::vector<std::int64_t> points;
+      std::vector<double> buffer;
+      forEach([&](std::size_t i, auto const& e) {
+        LocalNodes const& nodes = localNodes_.at(e.type());
+        std::size_t k = firstNode(i);
+        xi.clear();
+        points.clear();
+        for (auto const& x : nodes.positions) {
+          std::int64_t p = cells_.connectivity[k++];
+          if (pointOwner_[p] == i) {
+            xi.push_back(x);
+            points.push_back(p);
+          }
+        }
+        if (!points.empty())
+          this->evaluatePointsFused(localFcts, e, fcts, xi, points, buffer, data);
+      });
+    });
+    return data;
+  }
+
+private:
+  // Position of the first node of cell `i` in the connectivity
+  std::size_t firstNode (std::size_t i) const
+  {
+    return i > 0 ? std::size_t(cells_.offsets[i-1]) : 0u;
+  }
+
+  // Map the nodes of the VTK Lagrange cell to the Dune reference element of type `t`
+  static LocalNodes makeLocalNodes (GeometryType const& t)
+  {
+    if (Vtk::cellTypeInfo(t, Vtk::LAGRANGE).type == 0)
+      DUNE_THROW(Dune::NotImplemented, "Lagrange cells of geometry type " << t << " not supported.");
+
+    Vtk::CellType cellType(t, Vtk::LAGRANGE);
+    auto refElem = referenceElement<typename LocalCoordinate::value_type, dim>(t);
+
+    LocalNodes nodes;
+    nodes.type = cellType.type();
+    const double scale = double(ORDER) * ORDER * ORDER;
+    for (auto const& x : Vtk::lagrangeNodes(nodes.type, ORDER)) {
+      auto w = Vtk::lagrangeCornerWeights(nodes.type, ORDER, x);
+
+      LocalCoordinate local(0);
+      std::vector<std::pair<int, std::int64_t>> weights;
+      for (std::size_t j = 0; j < w.size(); ++j) {
+        if (w[j] == 0)
+          continue;
+        int corner = cellType.permutation(j);
+        local.axpy(w[j] / scale, refElem.position(corner, dim));
+        weights.emplace_back(corner, w[j]);
+      }
+      nodes.positions.push_back(local);
+      nodes.weights.push_back(std::move(weights));
+    }
+    return nodes;
+  }
+
+protected:
+  using Super::gridView_;
+  std::uint64_t numPoints_ = 0;
+  Cells cells_;
+  std::map<GeometryType, LocalNodes> localNodes_;
+  std::vector<std::size_t> pointOwner_; //< position of the cell that writes the node values
+};
+
+} // end namespace Dune
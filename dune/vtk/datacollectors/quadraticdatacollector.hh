@@ -1,5 +1,7 @@
 #pragma once
 
+#include <utility>
+
 #include "unstructureddatacollector.hh"
 
 namespace Dune
@@ -102,35 +104,93 @@ public:
     return cells;
   }
 
+  /// Return the sum of the number of vertices and edges of all cells
+  std::uint64_t connectivitySizeImpl () const
+  {
+    std::uint64_t n = 0;
+    for (auto const& c : elements(gridView_, partition))
+      n += c.subEntities(dim) + c.subEntities(dim-1);
+    return n;
+  }
+
+  /// Pass the VTK cell types in chunks to the `sink`
+  template <class Sink>
+  void typesChunkedImpl (Sink& sink, std::size_t chunkSize) const
+  {
+    Vtk::ChunkBuffer<std::uint8_t,Sink> types(sink, chunkSize);
+    for (auto const& c : elements(gridView_, partition))
+      types.push_back(Vtk::CellType{c.type(), Vtk::QUADRATIC}.type());
+    types.flush();
+  }
+
+  /// Pass the cell offsets in chunks to the `sink`
+  template <class Sink>
+  void offsetsChunkedImpl (Sink& sink, std::size_t chunkSize) const
+  {
+    Vtk::ChunkBuffer<std::int64_t,Sink> offsets(sink, chunkSize);
+    std::int64_t old_o = 0;
+    for (auto const& c : elements(gridView_, partition))
+      offsets.push_back(old_o += c.subEntities(dim) + c.subEntities(dim-1));
+    offsets.flush();
+  }
+
+  /// Pass the cell connectivity in chunks to the `sink`, in the same order as \ref cellsImpl
+  template <class Sink>
+  void connectivityChunkedImpl (Sink& sink, std::size_t chunkSize) const
+  {
+    Vtk::ChunkBuffer<std::int64_t,Sink> connectivity(sink, chunkSize);
+    auto const& indexSet = gridView_.indexSet();
+    for (auto const& c : elements(gridView_, partition)) {
+      Vtk::CellType cellType(c.type(), Vtk::QUADRATIC);
+      for (unsigned int j = 0; j < c.subEntities(dim); ++j)
+        connectivity.push_back(indexSet.subIndex(c,cellType.permutation(j),dim));
+      for (unsigned int j = 0; j < c.subEntities(dim-1); ++j) {
+        int k = cellType.permutation(c.subEntities(dim) + j);
+        connectivity.push_back(indexSet.subIndex(c,k,dim-1) + gridView_.size(dim));
+      }
+    }
+    connectivity.flush();
+  }
+
   /// Evaluate the `fct` at element vertices and edge centers in the same order as the point coords.
   template <class T, class GlobalFunction>
   std::vector<T> pointDataImpl (GlobalFunction const& fct) const
   {
-    std::vector<T> data(this->numPoints() * fct.ncomps());
+    return std::move(pointDataFusedImpl<T>(std::vector<GlobalFunction>{fct}).front());
+  }
+
+  /// Evaluate all `fcts` at element vertices and edge centers in one traversal
+  template <class T, class GlobalFunction>
+  std::vector<std::vector<T>> pointDataFusedImpl (std::vector<GlobalFunction> const& fcts) const
+  {
+    auto data = this->template makeDataFused<T>(this->numPoints(), fcts);
     auto const& indexSet = gridView_.indexSet();
-    auto localFct = localFunction(fct);
+    auto localFcts = this->localFunctions(fcts);
+    std::vector<LocalCoordinate> xi;
+    std::vector<std::size_t> points;
+    std::vector<double> buffer;
     for (auto const& e : elements(gridView_, partition)) {
-      localFct.bind(e);
       Vtk::CellType cellType{e.type(), Vtk::QUADRATIC};
       auto refElem = referenceElement(e.geometry());
+      xi.clear();
+      points.clear();
       for (unsigned int j = 0; j < e.subEntities(dim); ++j) {
         int k = cellType.permutation(j);
-        std::size_t idx = fct.ncomps() * indexSet.subIndex(e, k, dim);
-        for (int comp = 0; comp < fct.ncomps(); ++comp)
-          data[idx + comp] = T(localFct.evaluate(comp, refElem.position(k, dim)));
+        xi.push_back(refElem.position(k, dim));
+        points.push_back(indexSet.subIndex(e, k, dim));
       }
       for (unsigned int j = 0; j < e.subEntities(dim-1); ++j) {
         int k = cellType.permutation(e.subEntities(dim) + j);
-        std::size_t idx = fct.ncomps() * (indexSet.subIndex(e, k, dim-1) + gridView_.size(dim));
-        for (int comp = 0; comp < fct.ncomps(); ++comp)
-          data[idx + comp] = T(localFct.evaluate(comp, refElem.position(k, dim-1)));
+        xi.push_back(refElem.position(k, dim-1));
+        points.push_back(indexSet.subIndex(e, k, dim-1) + gridView_.size(dim));
       }
-      localFct.unbind();
+      this->evaluatePointsFused(localFcts, e, fcts, xi, points, buffer, data);
     }
     return data;
   }
 
 protected:
+  using typename Super::LocalCoordinate;
   using Super::gridView_;
 };
 
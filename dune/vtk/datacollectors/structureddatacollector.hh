@@ -137,6 +137,20 @@ public: // default implementation:
     return subDataCollector_.template pointData<T>(fct);
   }
 
+  /// \copydoc DefaultDataCollector::pointDataFused
+  template <class T, class GlobalFunction>
+  std::vector<std::vector<T>> pointDataFusedImpl (std::vector<GlobalFunction> const& fcts) const
+  {
+    return subDataCollector_.template pointDataFused<T>(fcts);
+  }
+
+  /// \copydoc DefaultDataCollector::pointsChunked
+  template <class T, class Sink>
+  void pointsChunkedImpl (Sink& sink, std::size_t chunkSize) const
+  {
+    subDataCollector_.template pointsChunked<T>(sink, chunkSize);
+  }
+
   // Calculates the extent and communicates it to rank 0.
   template <class Writer>
   void writeLocalPieceImpl (Writer const& writer) const
@@ -0,0 +1,305 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/virtualrefinement.hh>
+#include <dune/vtk/utility/chunkbuffer.hh>
+#include <dune/vtk/utility/cornerweights.hh>
+#include <dune/vtk/utility/nodenumbering.hh>
+
+#include "unstructureddatacollector.hh"
+
+namespace Dune
+{
+
+/// Implementation of \ref DataCollector for elements refined into linear sub-cells.
+/**
+ * Each element is refined `LEVEL` times by the virtual refinement of dune-geometry and the
+ * sub-cells are written as linear cells. Simplices and cubes are refined into sub-cells
+ * of the same type, prisms and pyramids into simplices. The data is evaluated at the refined
+ * vertices and, for cell data, at the centers of the sub-cells.
+ *
+ * If `CONTINUOUS` is true, refined vertices on the boundary of an element are shared with
+ * the neighboring elements of the partition, otherwise each element gets its own points.
+ **/
+template <class GridView, int LEVEL, bool CONTINUOUS, class Partition>
+class SubsamplingDataCollector
+    : public UnstructuredDataCollectorInterface<GridView, SubsamplingDataCollector<GridView,LEVEL,CONTINUOUS,Partition>, Partition>
+{
+  using Self = SubsamplingDataCollector;
+  using Super = UnstructuredDataCollectorInterface<GridView, Self, Partition>;
+
+  static_assert(LEVEL >= 0, "Refinement level must not be negative.");
+
+  using ctype = typename GridView::ctype;
+  using LocalCoordinate = typename GridView::template Codim<0>::Entity::Geometry::LocalCoordinate;
+
+public:
+  using Super::dim;
+  using Super::partition;
+
+  /// The refinement of one geometry type with the sub-cells in VTK ordering
+  struct LocalRefinement
+  {
+    std::vector<LocalCoordinate> points;    //< refined vertices
+    std::vector<std::vector<std::pair<int, std::int64_t>>> weights; //< nonzero corner weights of the points
+    std::vector<LocalCoordinate> centers;   //< centers of the sub-cells
+    std::vector<std::uint8_t> types;        //< VTK cell types of the sub-cells
+    std::vector<int> offsets;               //< offsets of the sub-cells in the connectivity
+    std::vector<int> connectivity;          //< local point indices of the sub-cells
+  };
+
+public:
+  SubsamplingDataCollector (GridView const& gridView)
+    : Super(gridView)
+  {}
+
+  /// Number the refined vertices and collect the sub-cells
+  void updateImpl ()
+  {
+    auto const& indexSet = gridView_.indexSet();
+    localRefinements_.clear();
+    for (auto const& t : indexSet.types(0))
+      localRefinements_.emplace(t, &localRefinement(t));
+
+    cells_ = Cells{};
+    pointIndex_.clear();
+    pointOffsets_.assign(1, 0);
+    cellOffsets_.assign(1, 0);
+    Vtk::NodeNumbering numbering;
+    numbering.reset(gridView_.size(dim));
+    for (auto const& e : elements(gridView_, partition)) {
+      LocalRefinement const& refinement = *localRefinements_.at(e.type());
+      auto vertexIndex = [&](int i) { return indexSet.subIndex(e, i, dim); };
+      std::size_t first = pointIndex_.size();
+      for (auto const& w : refinement.weights)
+        pointIndex_.push_back(CONTINUOUS ? numbering.index(w, e.subEntities(dim), vertexIndex)
+                                         : std::int64_t(pointIndex_.size()));
+
+      std::int64_t old_o = cells_.connectivity.size();
+      for (std::size_t c = 0; c < refinement.types.size(); ++c) {
+        for (int j = c > 0 ? refinement.offsets[c-1] : 0; j < refinement.offsets[c]; ++j)
+          cells_.connectivity.push_back(pointIndex_[first + refinement.connectivity[j]]);
+        cells_.offsets.push_back(old_o + refinement.offsets[c]);
+        cells_.types.push_back(refinement.types[c]);
+      }
+      pointOffsets_.push_back(pointIndex_.size());
+      cellOffsets_.push_back(cells_.types.size());
+    }
+    numPoints_ = CONTINUOUS ? numbering.size() : pointIndex_.size();
+
+    // the last element containing a point writes its values, as in a sequential traversal
+    pointOwner_.resize(numPoints_);
+    for (std::size_t i = 0; i+1 < pointOffsets_.size(); ++i)
+      for (std::size_t k = pointOffsets_[i]; k < pointOffsets_[i+1]; ++k)
+        pointOwner_[pointIndex_[k]] = i;
+  }
+
+  /// Return the number of refined vertices
+  std::uint64_t numPointsImpl () const
+  {
+    return numPoints_;
+  }
+
+  /// Return the coordinates of the refined vertices
+  template <class T>
+  std::vector<T> pointsImpl () const
+  {
+    std::vector<T> data(numPoints_ * 3);
+    this->forEachElementChunk([&](std::size_t /*k*/, auto forEach) {
+      forEach([&](std::size_t i, auto const& e) {
+        LocalRefinement const& refinement = *localRefinements_.at(e.type());
+        auto geometry = e.geometry();
+        std::size_t k = pointOffsets_[i];
+        for (auto const& x : refinement.points) {
+          std::int64_t p = pointIndex_[k++];
+          if (pointOwner_[p] != i)
+            continue;
+          auto v = geometry.global(x);
+          for (std::size_t j = 0; j < v.size(); ++j)
+            data[3*p + j] = T(v[j]);
+          for (std::size_t j = v.size(); j < 3u; ++j)
+            data[3*p + j] = T(0);
+        }
+      });
+    });
+    return data;
+  }
+
+  /// Return number of sub-cells
+  std::uint64_t numCellsImpl () const
+  {
+    return cells_.types.size();
+  }
+
+  /// Return the types, offsets and connectivity of the sub-cells, computed in \ref updateImpl
+  Cells const& cellsImpl () const
+  {
+    return cells_;
+  }
+
+  /// Return the number of corners of all sub-cells
+  std::uint64_t connectivitySizeImpl () const
+  {
+    return cells_.connectivity.size();
+  }
+
+  /// Evaluate the `fct` at the refined vertices
+  template <class T, class GlobalFunction>
+  std::vector<T> pointDataImpl (GlobalFunction const& fct) const
+  {
+    return std::move(pointDataFusedImpl<T>(std::vector<GlobalFunction>{fct}).front());
+  }
+
+  /// Evaluate all `fcts` at the refined vertices in one traversal
+  template <class T, class GlobalFunction>
+  std::vector<std::vector<T>> pointDataFusedImpl (std::vector<GlobalFunction> const& fcts) const
+  {
+    auto data = this->template makeDataFused<T>(numPoints_, fcts);
+    this->forEachElementChunk(fcts, [&](std::size_t /*k*/, auto forEach) {
+      auto localFcts = this->localFunctions(fcts);
+      std::vector<LocalCoordinate> xi;
+      std::vector<std::int64_t> points;
+      std::vector<double> buffer;
+      forEach([&](std::size_t i, auto const& e) {
+        LocalRefinement const& refinement = *localRefinements_.at(e.type());
+        std::size_t k = pointOffsets_[i];
+        xi.clear();
+        points.clear();
+        for (auto const& x : refinement.points) {
+          std::int64_t p = pointIndex_[k++];
+          if (pointOwner_[p] == i) {
+            xi.push_back(x);
+            points.push_back(p);
+          }
+        }
+        if (!points.empty())
+          this->evaluatePointsFused(localFcts, e, fcts, xi, points, buffer, data);
+      });
+    });
+    return data;
+  }
+
+  /// Evaluate all `fcts` at the centers of the sub-cells in one traversal
+  template <class T, class GlobalFunction>
+  std::vector<std::vector<T>> cellDataFusedImpl (std::vector<GlobalFunction> const& fcts) const
+  {
+    auto data = this->template makeDataFused<T>(numCellsImpl(), fcts);
+    this->forEachElementChunk(fcts, [&](std::size_t /*k*/, auto forEach) {
+      auto localFcts = this->localFunctions(fcts);
+      std::vector<double> buffer;
+      forEach([&](std::size_t i, auto const& e) {
+        LocalRefinement const& refinement = *localRefinements_.at(e.type());
+        for (std::size_t f = 0; f < fcts.size(); ++f) {
+          int ncomps = fcts[f].ncomps();
+          localFcts[f].bind(e);
+          buffer.resize(refinement.centers.size() * ncomps);
+          localFcts[f].evaluateAll(refinement.centers, ncomps, buffer.data());
+          std::copy(buffer.begin(), buffer.end(), data[f].begin() + ncomps * cellOffsets_[i]);
+          localFcts[f].unbind();
+        }
+      });
+    });
+    return data;
+  }
+
+  /// Evaluate the `fct` at the centers of the sub-cells and pass the values in chunks. With a
+  /// thread pool, the values are collected in parallel first.
+  template <class T, class GlobalFunction, class Sink>
+  void cellDataChunkedImpl (GlobalFunction const& fct, Sink& sink, std::size_t chunkSize) const
+  {
+    if (this->threaded()) {
+      Vtk::passChunks(this->template cellData<T>(fct), sink, chunkSize);
+      return;
+    }
+
+    Vtk::ChunkBuffer<T,Sink> data(sink, chunkSize);
+    auto localFct = localFunction(fct);
+    std::vector<double> buffer;
+    for (auto const& e : elements(gridView_, partition)) {
+      localFct.bind(e);
+      LocalRefinement const& refinement = *localRefinements_.at(e.type());
+      buffer.resize(refinement.centers.size() * fct.ncomps());
+      localFct.evaluateAll(refinement.centers, fct.ncomps(), buffer.data());
+      for (double value : buffer)
+        data.push_back(T(value));
+      localFct.unbind();
+    }
+    data.flush();
+  }
+
+  /// \brief Return the refinement of the reference element of type `t`
+  /**
+   * The refinement is computed once per geometry type and stored in a cache shared by all
+   * collectors of this type, i.e., with the same grid view type and refinement level.
+   **/
+  static LocalRefinement const& localRefinement (GeometryType const& t)
+  {
+    static std::map<GeometryType, LocalRefinement> cache;
+    static std::mutex mutex;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(t);
+    if (it == cache.end())
+      it = cache.emplace(t, makeLocalRefinement(t)).first;
+    return it->second;
+  }
+
+private:
+  // Refine the reference element of type `t` and number the sub-cell corners in VTK ordering
+  static LocalRefinement makeLocalRefinement (GeometryType const& t)
+  {
+    GeometryType coerceTo = t.isSimplex() || t.isCube() ? t : GeometryTypes::simplex(dim);
+    auto& refinement = buildRefinement<dim, ctype>(t, coerceTo);
+    auto tag = refinementLevels(LEVEL);
+    Vtk::CellType cellType(coerceTo);
+
+    LocalRefinement local;
+    const double scale = std::ldexp(1.0, 3*LEVEL);
+    for (auto it = refinement.vBegin(tag); it != refinement.vEnd(tag); ++it) {
+      LocalCoordinate x = it.coords();
+      auto w = Vtk::cornerWeights(t, x);
+      std::vector<std::pair<int, std::int64_t>> weights;
+      for (std::size_t i = 0; i < w.size(); ++i) {
+        std::int64_t wi = std::llround(w[i] * scale);
+        if (wi != 0)
+          weights.emplace_back(int(i), wi);
+      }
+      local.points.push_back(x);
+      local.weights.push_back(std::move(weights));
+    }
+
+    for (auto it = refinement.eBegin(tag); it != refinement.eEnd(tag); ++it) {
+      auto indices = it.vertexIndices();
+      LocalCoordinate center(0);
+      for (std::size_t j = 0; j < indices.size(); ++j) {
+        local.connectivity.push_back(indices[cellType.permutation(j)]);
+        center += local.points[indices[j]];
+      }
+      center /= ctype(indices.size());
+      local.centers.push_back(center);
+      local.offsets.push_back(int(local.connectivity.size()));
+      local.types.push_back(cellType.type());
+    }
+    return local;
+  }
+
+protected:
+  using Super::gridView_;
+  std::uint64_t numPoints_ = 0;
+  Cells cells_;
+  std::vector<std::int64_t> pointIndex_;  //< point index of each refined vertex of each element
+  std::vector<std::size_t> pointOffsets_; //< position of the first refined vertex of each element in pointIndex_
+  std::vector<std::size_t> cellOffsets_;  //< position of the first sub-cell of each element
+  std::vector<std::size_t> pointOwner_;   //< position of the element that writes the point values
+  std::map<GeometryType, LocalRefinement const*> localRefinements_;
+};
+
+} // end namespace Dune
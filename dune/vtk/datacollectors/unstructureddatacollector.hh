@@ -30,7 +30,11 @@ public:
   {}
 
   /// \brief Return cell types, offsets, and connectivity. \see Cells
-  Cells cells () const
+  /**
+   * Collectors that store the cells return a reference, all others build the cells
+   * in each call.
+   **/
+  decltype(auto) cells () const
   {
     return this->asDerived().cellsImpl();
   }
@@ -40,13 +44,66 @@ public:
     return this->asDerived().pointIdsImpl();
   }
 
-protected:
-  // default implementation
+  /// Return the length of the connectivity vector, i.e., the sum of the number of cell points
+  std::uint64_t connectivitySize () const
+  {
+    return this->asDerived().connectivitySizeImpl();
+  }
+
+  /// \brief Pass the cell types, offsets, or connectivity in chunks to the `sink`.
+  /// \see cells, \see DataCollectorInterface::pointsChunked
+  /// @{
+  template <class Sink>
+  void typesChunked (Sink&& sink, std::size_t chunkSize) const
+  {
+    this->asDerived().typesChunkedImpl(sink, chunkSize);
+  }
+
+  template <class Sink>
+  void offsetsChunked (Sink&& sink, std::size_t chunkSize) const
+  {
+    this->asDerived().offsetsChunkedImpl(sink, chunkSize);
+  }
+
+  template <class Sink>
+  void connectivityChunked (Sink&& sink, std::size_t chunkSize) const
+  {
+    this->asDerived().connectivityChunkedImpl(sink, chunkSize);
+  }
+  /// @}
+
+public: // default implementations
   std::vector<std::uint64_t> pointIdsImpl () const
   {
     return {};
   }
 
+  std::uint64_t connectivitySizeImpl () const
+  {
+    return this->asDerived().cellsImpl().connectivity.size();
+  }
+
+  // The default implementations collect all cells and pass the vectors in chunks. Collectors
+  // that build the cells in \ref cellsImpl should override these to avoid building them for
+  // each call, collectors that store the cells return them by reference from \ref cellsImpl.
+  template <class Sink>
+  void typesChunkedImpl (Sink& sink, std::size_t chunkSize) const
+  {
+    Vtk::passChunks(this->asDerived().cellsImpl().types, sink, chunkSize);
+  }
+
+  template <class Sink>
+  void offsetsChunkedImpl (Sink& sink, std::size_t chunkSize) const
+  {
+    Vtk::passChunks(this->asDerived().cellsImpl().offsets, sink, chunkSize);
+  }
+
+  template <class Sink>
+  void connectivityChunkedImpl (Sink& sink, std::size_t chunkSize) const
+  {
+    Vtk::passChunks(this->asDerived().cellsImpl().connectivity, sink, chunkSize);
+  }
+
 protected:
   using Super::gridView_;
 };
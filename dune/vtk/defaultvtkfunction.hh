@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
+
 #include "vtklocalfunctioninterface.hh"
 
 namespace Dune
@@ -49,6 +52,28 @@ namespace Dune
       return evaluateImpl(comp, localFct_(xi));
     }
 
+    /// Evaluate the LocalFunction once per local coordinate and extract all components
+    virtual void evaluateAll (LocalCoordinate const* xi, std::size_t n, int ncomps, double* values) const override
+    {
+      for (std::size_t i = 0; i < n; ++i) {
+        auto&& y = localFct_(xi[i]);
+        for (int comp = 0; comp < ncomps; ++comp)
+          values[i*ncomps + comp] = evaluateImpl(comp, y);
+      }
+    }
+
+    /// The wrapper can be cloned, see \ref clone
+    virtual bool cloneable () const override
+    {
+      return true;
+    }
+
+    /// Return a wrapper around a copy of the LocalFunction
+    virtual std::unique_ptr<Interface> clone () const override
+    {
+      return std::make_unique<Self>(localFct_);
+    }
+
   private:
     // Evaluate a component of a vector valued data
     template <class T, int N, int M>
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <dune/vtk/utility/derivedfield.hh>
+
+#include "vtklocalfunctioninterface.hh"
+
+namespace Dune
+{
+  /// Local function of a \ref Vtk::DerivedField, evaluating the local functions of its sources
+  /**
+   * Writers compute derived fields from the arrays of the sources collected in the same
+   * write, if possible. This function is used for all other output, e.g., in ASCII format.
+   **/
+  template <class GridView, class LocalFunction>
+  class DerivedLocalFunctionWrapper final
+      : public VtkLocalFunctionInterface<GridView>
+  {
+    using Interface = VtkLocalFunctionInterface<GridView>;
+    using Entity = typename Interface::Entity;
+    using LocalCoordinate = typename Interface::LocalCoordinate;
+
+  public:
+    /// Constructor. Stores the `derived` field and the local functions of its `sources`,
+    /// each with `ncomps` components
+    DerivedLocalFunctionWrapper (Vtk::DerivedField const& derived,
+                                 std::vector<LocalFunction> sources, int ncomps)
+      : derived_(derived)
+      , sources_(std::move(sources))
+      , ncomps_(ncomps)
+    {}
+
+    /// Bind the local functions of all sources
+    virtual void bind (Entity const& entity) override
+    {
+      for (auto& source : sources_)
+        source.bind(entity);
+    }
+
+    /// Unbind the local functions of all sources
+    virtual void unbind () override
+    {
+      for (auto& source : sources_)
+        source.unbind();
+    }
+
+    /// Evaluate the component `comp` at the local coordinate `xi`
+    virtual double evaluate (int comp, LocalCoordinate const& xi) const override
+    {
+      double values[9];
+      evaluateAll(&xi, 1, comp+1, values);
+      return values[comp];
+    }
+
+    /// Evaluate the sources at all `xi` and apply the operation of the derived field
+    virtual void evaluateAll (LocalCoordinate const* xi, std::size_t n, int ncomps, double* values) const override
+    {
+      xi_.assign(xi, xi + n);
+      buffers_.resize(sources_.size());
+      std::vector<double const*> ptrs;
+      for (std::size_t s = 0; s < sources_.size(); ++s) {
+        buffers_[s].resize(n * ncomps_);
+        sources_[s].evaluateAll(xi_, ncomps_, buffers_[s].data());
+        ptrs.push_back(buffers_[s].data());
+      }
+
+      const int m = derived_.ncomps(ncomps_);
+      result_.resize(n * m);
+      derived_.apply(ptrs.data(), n, ncomps_, result_.data());
+      for (std::size_t i = 0; i < n; ++i)
+        for (int comp = 0; comp < ncomps; ++comp)
+          values[i*ncomps + comp] = comp < m ? result_[i*m + comp] : 0.0;
+    }
+
+    /// Return whether the local functions of all sources can be cloned
+    virtual bool cloneable () const override
+    {
+      return std::all_of(sources_.begin(), sources_.end(), [](auto const& source) {
+        return source.cloneable(); });
+    }
+
+    /// Return a wrapper around clones of the local functions of the sources
+    virtual std::unique_ptr<Interface> clone () const override
+    {
+      std::vector<LocalFunction> sources;
+      for (auto const& source : sources_)
+        sources.push_back(source.clone());
+      return std::make_unique<DerivedLocalFunctionWrapper>(derived_, std::move(sources), ncomps_);
+    }
+
+  private:
+    Vtk::DerivedField derived_;
+    std::vector<LocalFunction> sources_;
+    int ncomps_;
+
+    mutable std::vector<LocalCoordinate> xi_;
+    mutable std::vector<std::vector<double>> buffers_;
+    mutable std::vector<double> result_;
+  };
+
+} // end namespace Dune
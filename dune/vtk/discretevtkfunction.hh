@@ -0,0 +1,259 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <dune/common/std/type_traits.hh>
+#include <dune/common/version.hh>
+#include <dune/geometry/type.hh>
+
+#if HAVE_DUNE_FUNCTIONS
+#if DUNE_VERSION_LT(DUNE_FUNCTIONS, 2, 7)
+#include <dune/functions/functionspacebases/pqknodalbasis.hh>
+#else
+#include <dune/functions/functionspacebases/lagrangebasis.hh>
+#endif
+#endif
+
+#include "vtklocalfunctioninterface.hh"
+
+namespace Dune
+{
+  namespace Vtk
+  {
+    /// \brief Whether the local finite element of the leaf basis node `Node` is determined by
+    /// the geometry type of the bound element, as for Lagrange bases
+    /**
+     * Only then the shape function values can be stored per geometry type and local
+     * coordinate, see \ref DiscreteLocalFunctionWrapper. Specialize this trait for other
+     * nodes with this property. Bases whose local finite element varies per element, e.g.,
+     * Hermite or Morley bases, bases of variable order, or bases with orientation-dependent
+     * shape functions, must not be marked.
+     **/
+    template <class Node>
+    struct IsLagrangeNode : std::false_type {};
+
+#if HAVE_DUNE_FUNCTIONS
+#if DUNE_VERSION_LT(DUNE_FUNCTIONS, 2, 7)
+    template <class GV, int k, class... R>
+    struct IsLagrangeNode<Functions::PQkNode<GV,k,R...>> : std::true_type {};
+#else
+    template <class GV, int k, class... R>
+    struct IsLagrangeNode<Functions::LagrangeNode<GV,k,R...>> : std::true_type {};
+#endif
+#endif
+
+    namespace Impl
+    {
+      template <class F>
+      using BasisLocalView = std::decay_t<decltype(std::declval<F const&>().basis().localView())>;
+
+      template <class F>
+      using BasisGridView = std::decay_t<decltype(std::declval<F const&>().basis().gridView())>;
+
+      template <class LV>
+      using LeafLocalBasis = std::decay_t<decltype(std::declval<LV const&>().tree().finiteElement().localBasis())>;
+
+      template <class LV>
+      using LeafNode = std::decay_t<decltype(std::declval<LV const&>().tree())>;
+
+      template <class F, class LV>
+      using Coefficient = decltype(double(std::declval<F const&>().dofs()[std::declval<LV const&>().index(0)]));
+
+      template <class F, class GridView,
+        bool = Std::is_detected<BasisLocalView,F>::value && Std::is_detected<BasisGridView,F>::value>
+      struct IsDiscreteScalarFunctionImpl : std::false_type {};
+
+      template <class F, class GridView>
+      struct IsDiscreteScalarFunctionImpl<F, GridView, true>
+      {
+        using LocalView = BasisLocalView<F>;
+
+        template <class LV, bool = Std::is_detected<LeafLocalBasis,LV>::value>
+        struct ScalarLeaf : std::false_type {};
+
+        template <class LV>
+        struct ScalarLeaf<LV, true>
+            : std::integral_constant<bool, LeafLocalBasis<LV>::Traits::dimRange == 1
+                                        && IsLagrangeNode<LeafNode<LV>>::value> {};
+
+        static constexpr bool value = std::is_same<BasisGridView<F>, GridView>::value
+          && ScalarLeaf<LocalView>::value
+          && Std::is_detected<Coefficient,F,LocalView>::value;
+      };
+
+    } // end namespace Impl
+
+
+    /// \brief Whether `F` is a discrete function of a global basis with a scalar leaf node, whose
+    /// local finite element depends on the geometry type only, defined on `GridView`
+    /**
+     * The function must provide `basis()`, with `localView()` and `gridView()`, and the
+     * coefficients `dofs()`, indexed by the global indices of the local view. The leaf node
+     * must be marked by \ref IsLagrangeNode, e.g., the node of a scalar Lagrange basis of
+     * dune-functions.
+     **/
+    template <class F, class GridView>
+    using IsDiscreteScalarFunction = Impl::IsDiscreteScalarFunctionImpl<std::decay_t<F>, GridView>;
+
+  } // end namespace Vtk
+
+
+  /// \brief Local function of a discrete function of a scalar global basis
+  /**
+   * The local basis functions are evaluated once per geometry type and node and stored in a
+   * table, without the zero values. The nodes are the local coordinates passed to
+   * \ref evaluateAll. A table stores at most `maxRows` nodes, the shape values at further
+   * nodes are computed in each evaluation. This requires that the local finite element
+   * is determined by the geometry type, see \ref Vtk::IsLagrangeNode. Evaluating the function
+   * at a point is a sparse dot-product of a table row with the coefficients of the bound
+   * element. For Lagrange bases evaluated at their nodes, e.g., P1 at the vertices, the
+   * coefficients are just copied.
+   **/
+  template <class GridView, class GlobalFunction>
+  class DiscreteLocalFunctionWrapper final
+      : public VtkLocalFunctionInterface<GridView>
+  {
+    using Interface = VtkLocalFunctionInterface<GridView>;
+    using Entity = typename Interface::Entity;
+    using LocalCoordinate = typename Interface::LocalCoordinate;
+
+    using LocalView = Vtk::Impl::BasisLocalView<GlobalFunction>;
+    using LocalBasis = Vtk::Impl::LeafLocalBasis<LocalView>;
+    using ShapeRange = typename LocalBasis::Traits::RangeType;
+
+    // Maximal number of nodes per geometry type whose shape values are stored
+    static constexpr std::size_t maxRows = 1024;
+
+    // The nonzero shape function values at a local coordinate, with the local dof indices
+    struct ShapeValues
+    {
+      LocalCoordinate x;
+      std::vector<std::pair<std::size_t, double>> values;
+    };
+
+  public:
+    /// Constructor. Stores a copy of the `fct`
+    DiscreteLocalFunctionWrapper (GlobalFunction const& fct)
+      : fct_(fct)
+      , localView_(fct_.basis().localView())
+    {}
+
+    /// Bind the local view of the basis to the entity
+    virtual void bind (Entity const& entity) override
+    {
+      localView_.bind(entity);
+      table_ = &tables_[entity.type()];
+    }
+
+    /// Unbind the local view
+    virtual void unbind () override
+    {
+      localView_.unbind();
+      table_ = nullptr;
+    }
+
+    /// Evaluate the function at the local coordinate `xi`, without storing the shape values
+    virtual double evaluate (int comp, LocalCoordinate const& xi) const override
+    {
+      return comp == 0 ? evaluateImpl(makeShapeValues(xi)) : 0.0;
+    }
+
+    /// Look up the shape function values at the nodes `xi` and combine them with the coefficients
+    virtual void evaluateAll (LocalCoordinate const* xi, std::size_t n, int ncomps, double* values) const override
+    {
+      for (std::size_t i = 0; i < n; ++i) {
+        values[i*ncomps] = evaluateImpl(shapeValues(i, xi[i]));
+        for (int comp = 1; comp < ncomps; ++comp)
+          values[i*ncomps + comp] = 0.0;
+      }
+    }
+
+    /// The wrapper can be cloned, see \ref clone
+    virtual bool cloneable () const override
+    {
+      return true;
+    }
+
+    /// Return a wrapper around a copy of the function, with its own local view and tables
+    virtual std::unique_ptr<Interface> clone () const override
+    {
+      return std::make_unique<DiscreteLocalFunctionWrapper>(fct_);
+    }
+
+  private:
+    double evaluateImpl (ShapeValues const& shapeValues) const
+    {
+      auto const& dofs = fct_.dofs();
+      if (shapeValues.values.size() == 1 && shapeValues.values[0].second == 1.0)
+        return double(dofs[localView_.index(shapeValues.values[0].first)]);
+
+      double value = 0.0;
+      for (auto const& v : shapeValues.values)
+        value += v.second * double(dofs[localView_.index(v.first)]);
+      return value;
+    }
+
+    // Return the row of the table of the bound geometry type for the node `x`, the `k`th of
+    // the nodes passed to \ref evaluateAll. The data collectors pass the same nodes for all
+    // elements of a geometry type, thus the rows are stored in the order of the nodes and
+    // row `k` is checked first. The search for nodes passed in another order, e.g., a subset
+    // of the nodes, starts after the last row found.
+    ShapeValues const& shapeValues (std::size_t k, LocalCoordinate const& x) const
+    {
+      assert(table_ != nullptr);
+      std::vector<ShapeValues>& table = *table_;
+      if (k < table.size() && table[k].x == x) {
+        hint_ = k + 1;
+        return table[k];
+      }
+
+      for (std::size_t i = 0; i < table.size(); ++i) {
+        std::size_t pos = (hint_ + i) % table.size();
+        if (table[pos].x == x) {
+          hint_ = pos + 1;
+          return table[pos];
+        }
+      }
+
+      if (table.size() >= maxRows) {
+        row_ = makeShapeValues(x);
+        return row_;
+      }
+
+      table.push_back(makeShapeValues(x));
+      hint_ = table.size();
+      return table.back();
+    }
+
+    // Evaluate the local basis at `x` and collect the nonzero values
+    ShapeValues makeShapeValues (LocalCoordinate const& x) const
+    {
+      auto const& node = localView_.tree();
+      node.finiteElement().localBasis().evaluateFunction(x, shapeRange_);
+      ShapeValues row{x, {}};
+      for (std::size_t j = 0; j < shapeRange_.size(); ++j) {
+        double w = shapeRange_[j];
+        if (w != 0.0)
+          row.values.emplace_back(node.localIndex(j), w);
+      }
+      return row;
+    }
+
+  private:
+    GlobalFunction fct_;
+    LocalView localView_;
+
+    mutable std::map<GeometryType, std::vector<ShapeValues>> tables_;
+    std::vector<ShapeValues>* table_ = nullptr;
+    mutable std::size_t hint_ = 0;
+    mutable ShapeValues row_; //< shape values at a node not stored in the full table
+    mutable std::vector<ShapeRange> shapeRange_;
+  };
+
+} // end namespace Dune
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <tuple>
+
 namespace Dune
 {
   // forward declaration of all classes in dune-vtk
@@ -20,6 +22,12 @@ namespace Dune
 
   template <class GridView>
   class QuadraticDataCollector;
+
+  template <class GridView, int ORDER = 2, class Partition = Partitions::InteriorBorder>
+  class LagrangeDataCollector;
+
+  template <class GridView, int LEVEL = 1, bool CONTINUOUS = true, class Partition = Partitions::InteriorBorder>
+  class SubsamplingDataCollector;
   // @} unstructured-datacollectors
 
   template <class GridView, class Derived>
@@ -99,6 +107,9 @@ namespace Dune
   class VtkUnstructuredGridWriter;
   // @} vtkwriters
 
+  template <class Writer, class PointFunctions = std::tuple<>, class CellFunctions = std::tuple<>>
+  class VtkTypedWriter;
+
   // @} filewriters
 
 } // end namespace Dune
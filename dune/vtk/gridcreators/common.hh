@@ -1,7 +1,13 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <type_traits>
 
+#include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/type.hh>
+#include <dune/vtk/vtktypes.hh>
+
 namespace Dune
 {
   template <class Factory, class... Args>
@@ -19,4 +25,41 @@ namespace Dune
   template <class GF>
   using VertexId_t = typename Impl::VertexIdType<GF>::type;
 
+  namespace Vtk
+  {
+    /// Geometry type, number of vertices and vertex permutation of the VTK cell types,
+    /// determined once per cell type on first access
+    template <int dim>
+    class CellTypeTable
+    {
+    public:
+      struct Entry
+      {
+        GeometryType type;
+        int numVertices = 0;
+        bool noPermutation = true;
+        int const* permutation = nullptr;   //< Dune vertex j is VTK vertex permutation[j]
+      };
+
+      /// Return the entry of the VTK cell type `vtkType`
+      Entry const& operator[] (std::uint8_t vtkType)
+      {
+        Entry& entry = entries_[vtkType];
+        if (!entry.permutation) {
+          entry.type = to_geometry(vtkType);
+          entry.numVertices = referenceElement<double,dim>(entry.type).size(dim);
+
+          auto const& info = cellTypeInfo(entry.type);
+          entry.noPermutation = info.noPermutation;
+          entry.permutation = info.permutation;
+        }
+        return entry;
+      }
+
+    private:
+      std::array<Entry, 256> entries_;
+    };
+
+  } // end namespace Vtk
+
 } // end namespace Dune
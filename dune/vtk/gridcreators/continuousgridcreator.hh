@@ -11,6 +11,7 @@
 
 #include <dune/vtk/vtktypes.hh>
 #include <dune/vtk/gridcreatorinterface.hh>
+#include <dune/vtk/gridcreators/common.hh>
 
 namespace Dune
 {
@@ -40,28 +41,28 @@ namespace Dune
                              std::vector<std::int64_t> const& offsets,
                              std::vector<std::int64_t> const& connectivity)
     {
+      Vtk::CellTypeTable<Grid::dimension> cellTypes;
+      std::vector<unsigned int> cell; // reused for all elements
+
       std::size_t idx = 0;
       for (std::size_t i = 0; i < types.size(); ++i) {
-        auto type = Vtk::to_geometry(types[i]);
-        Vtk::CellType cellType{type};
-        auto refElem = referenceElement<double,Grid::dimension>(type);
+        auto const& cellType = cellTypes[types[i]];
 
         int nNodes = offsets[i] - (i == 0 ? 0 : offsets[i-1]);
-        assert(nNodes == refElem.size(Grid::dimension));
-        std::vector<unsigned int> vtk_cell; vtk_cell.reserve(nNodes);
-        for (int j = 0; j < nNodes; ++j)
-          vtk_cell.push_back( connectivity[idx++] );
+        assert(nNodes == cellType.numVertices);
+        cell.resize(nNodes);
 
-        if (cellType.noPermutation())
-          factory().insertElement(type,vtk_cell);
-        else {
-          // apply index permutation
-          std::vector<unsigned int> cell(nNodes);
+        // apply index permutation
+        if (cellType.noPermutation) {
           for (int j = 0; j < nNodes; ++j)
-            cell[j] = vtk_cell[cellType.permutation(j)];
-
-          factory().insertElement(type,cell);
+            cell[j] = connectivity[idx + j];
+        } else {
+          for (int j = 0; j < nNodes; ++j)
+            cell[j] = connectivity[idx + cellType.permutation[j]];
         }
+        idx += nNodes;
+
+        factory().insertElement(cellType.type, cell);
       }
     }
   };
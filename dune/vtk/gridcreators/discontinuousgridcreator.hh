@@ -11,6 +11,9 @@
 
 #include <dune/vtk/vtktypes.hh>
 #include <dune/vtk/gridcreatorinterface.hh>
+#include <dune/vtk/gridcreators/common.hh>
+#include <dune/vtk/utility/vertexwelder.hh>
+
 namespace Dune
 {
   // Create a grid where the input points are not connected and the connectivity
@@ -22,75 +25,55 @@ namespace Dune
     using Super = GridCreatorInterface<Grid, DiscontinuousGridCreator<Grid>>;
     using GlobalCoordinate = typename Super::GlobalCoordinate;
 
-    struct CoordLess
-    {
-      template <class T, int N>
-      bool operator() (FieldVector<T,N> const& lhs, FieldVector<T,N> const& rhs) const
-      {
-        for (int i = 0; i < N; ++i) {
-          if (std::abs(lhs[i] - rhs[i]) < std::numeric_limits<T>::epsilon())
-            continue;
-          return lhs[i] < rhs[i];
-        }
-        return false;
-      }
-    };
+    using ctype = typename GlobalCoordinate::value_type;
 
-    DiscontinuousGridCreator (GridFactory<Grid>& factory)
+    /// Constructor. Points with a distance less than `tolerance` in each component are merged.
+    DiscontinuousGridCreator (GridFactory<Grid>& factory,
+                              double tolerance = std::numeric_limits<ctype>::epsilon())
       : Super(factory)
+      , tolerance_(tolerance)
     {}
 
     using Super::factory;
     void insertVerticesImpl (std::vector<GlobalCoordinate> const& points,
                              std::vector<std::uint64_t> const& /*point_ids*/)
     {
-      points_ = &points;
-      uniquePoints_.clear();
-      std::size_t idx = 0;
-
-      for (auto const& p : points) {
-        auto b = uniquePoints_.emplace(std::make_pair(p,idx));
-        if (b.second) {
-          factory().insertVertex(p);
-          ++idx;
-        }
-      }
+      auto welded = Vtk::weldPoints(points, tolerance_);
+      for (std::size_t i : welded.unique)
+        factory().insertVertex(points[i]);
+      uniqueIndex_ = std::move(welded.index);
     }
 
     void insertElementsImpl (std::vector<std::uint8_t> const& types,
                              std::vector<std::int64_t> const& offsets,
                              std::vector<std::int64_t> const& connectivity)
     {
-      assert(points_ != nullptr);
+      Vtk::CellTypeTable<Grid::dimension> cellTypes;
+      std::vector<unsigned int> cell; // reused for all elements
+
       std::size_t idx = 0;
       for (std::size_t i = 0; i < types.size(); ++i) {
-        auto type = Vtk::to_geometry(types[i]);
-        Vtk::CellType cellType{type};
+        auto const& cellType = cellTypes[types[i]];
 
         int nNodes = offsets[i] - (i == 0 ? 0 : offsets[i-1]);
-        assert(nNodes > 0);
-        std::vector<unsigned int> vtk_cell; vtk_cell.reserve(nNodes);
+        assert(nNodes == cellType.numVertices);
+        cell.resize(nNodes);
+
+        // apply index permutation and map to the merged vertices
         for (int j = 0; j < nNodes; ++j) {
-          std::size_t v_j = connectivity[idx++];
-          std::size_t new_idx = uniquePoints_[(*points_)[v_j]];
-          vtk_cell.push_back(new_idx);
+          std::size_t v_j = connectivity[idx + (cellType.noPermutation ? j : cellType.permutation[j])];
+          assert(v_j < uniqueIndex_.size());
+          cell[j] = uniqueIndex_[v_j];
         }
+        idx += nNodes;
 
-        if (cellType.noPermutation()) {
-          factory().insertElement(type,vtk_cell);
-        } else {
-          // apply index permutation
-          std::vector<unsigned int> cell(nNodes);
-          for (int j = 0; j < nNodes; ++j)
-            cell[j] = vtk_cell[cellType.permutation(j)];
-          factory().insertElement(type,cell);
-        }
+        factory().insertElement(cellType.type, cell);
       }
     }
 
   private:
-    std::vector<GlobalCoordinate> const* points_ = nullptr;
-    std::map<GlobalCoordinate, std::size_t, CoordLess> uniquePoints_;
+    double tolerance_;
+    std::vector<std::size_t> uniqueIndex_; //< index of the merged vertex of each input point
   };
 
 } // end namespace Dune
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <dune/geometry/type.hh>
+#include <dune/vtk/utility/cornerweights.hh>
+#include <dune/vtk/utility/indexedvalues.hh>
+
+#include "vtklocalfunctioninterface.hh"
+
+namespace Dune
+{
+  /// Local function of values attached to the elements or vertices of a grid
+  /**
+   * Values attached to the elements are constant on each element, values attached to the
+   * vertices are interpolated by the linear shape functions of the element corners. Data
+   * collectors that write the values at elements or vertices copy them directly from the
+   * \ref Vtk::IndexedValues, this function is used for all other points.
+   **/
+  template <class GridView>
+  class IndexedLocalFunctionWrapper final
+      : public VtkLocalFunctionInterface<GridView>
+  {
+    using Interface = VtkLocalFunctionInterface<GridView>;
+    using Entity = typename Interface::Entity;
+    using LocalCoordinate = typename Interface::LocalCoordinate;
+
+    static constexpr int dim = GridView::dimension;
+
+  public:
+    /// Constructor. Stores a copy of the `gridView` and of the view to the `values`
+    IndexedLocalFunctionWrapper (GridView const& gridView, Vtk::IndexedValues const& values)
+      : gridView_(gridView)
+      , values_(values)
+    {}
+
+    /// Collect the indices of the element, or of its vertices
+    virtual void bind (Entity const& entity) override
+    {
+      auto const& indexSet = gridView_.indexSet();
+      type_ = entity.type();
+      indices_.clear();
+      if (values_.codim() == 0)
+        indices_.push_back(indexSet.index(entity));
+      else
+        for (unsigned int j = 0; j < entity.subEntities(dim); ++j)
+          indices_.push_back(indexSet.subIndex(entity, j, dim));
+    }
+
+    /// Remove the collected indices
+    virtual void unbind () override
+    {
+      indices_.clear();
+    }
+
+    /// Evaluate the component `comp` at the local coordinate `xi`
+    virtual double evaluate (int comp, LocalCoordinate const& xi) const override
+    {
+      double values[9];
+      evaluateAll(&xi, 1, comp+1, values);
+      return values[comp];
+    }
+
+    /// Gather the values of the element or of its vertices and interpolate them at all `xi`
+    virtual void evaluateAll (LocalCoordinate const* xi, std::size_t n, int ncomps, double* values) const override
+    {
+      blocks_.resize(indices_.size() * ncomps);
+      values_.gather(indices_, ncomps, blocks_.data());
+      for (std::size_t i = 0; i < n; ++i) {
+        if (values_.codim() == 0) {
+          std::copy(blocks_.begin(), blocks_.end(), values + i*ncomps);
+          continue;
+        }
+
+        auto w = Vtk::cornerWeights(type_, xi[i]);
+        for (int comp = 0; comp < ncomps; ++comp) {
+          double value = 0.0;
+          for (std::size_t j = 0; j < w.size(); ++j)
+            value += w[j] * blocks_[j*ncomps + comp];
+          values[i*ncomps + comp] = value;
+        }
+      }
+    }
+
+    /// The wrapper can be cloned, see \ref clone
+    virtual bool cloneable () const override
+    {
+      return true;
+    }
+
+    /// Return a wrapper around the same values, with its own bound element
+    virtual std::unique_ptr<Interface> clone () const override
+    {
+      return std::make_unique<IndexedLocalFunctionWrapper>(gridView_, values_);
+    }
+
+  private:
+    GridView gridView_;
+    Vtk::IndexedValues values_;
+
+    GeometryType type_;
+    std::vector<std::size_t> indices_;
+    mutable std::vector<double> blocks_;
+  };
+
+} // end namespace Dune
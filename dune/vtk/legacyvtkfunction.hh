@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 
 #include <dune/grid/io/file/vtk/function.hh>
@@ -41,6 +42,27 @@ namespace Dune
       return fct_->evaluate(comp, *entity_, xi);
     }
 
+    /// Evaluate all components of the Dune::VTKFunction at the local coordinates `xi`
+    virtual void evaluateAll (LocalCoordinate const* xi, std::size_t n, int ncomps, double* values) const override
+    {
+      VTKFunction<GridView> const& fct = *fct_;
+      for (std::size_t i = 0; i < n; ++i)
+        for (int comp = 0; comp < ncomps; ++comp)
+          values[i*ncomps + comp] = fct.evaluate(comp, *entity_, xi[i]);
+    }
+
+    /// The wrapper can be cloned, see \ref clone
+    virtual bool cloneable () const override
+    {
+      return true;
+    }
+
+    /// Return a wrapper around the same Dune::VTKFunction, with its own entity pointer
+    virtual std::unique_ptr<Interface> clone () const override
+    {
+      return std::make_unique<VTKLocalFunctionWrapper>(fct_);
+    }
+
   private:
     std::shared_ptr<VTKFunction<GridView> const> fct_;
     Entity const* entity_;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <future>
 #include <iosfwd>
 #include <string>
 #include <vector>
@@ -42,6 +43,16 @@ namespace Dune
     void writeTimestep (double time, std::string const& fn, Std::optional<std::string> dir = {},
                         bool writeCollection = true) const;
 
+    /// \brief Write the attached data to the file in a background thread
+    /**
+     * Same as \ref writeTimestep, but the timestep files are written asynchronously,
+     * see \ref VtkWriterInterface::writeAsync. The .pvd file is written directly.
+     * Returns a future that becomes ready when the timestep files are written.
+     **/
+    std::future<void> writeTimestepAsync (double time, std::string const& fn,
+                                          Std::optional<std::string> dir = {},
+                                          bool writeCollection = true) const;
+
     /// \brief Writes collection of timesteps to .pvd file.
     // NOTE: requires an aforgoing call to \ref writeTimestep
     /**
@@ -68,6 +79,11 @@ namespace Dune
     }
 
   protected:
+    // Register the timestep and write the timestep files with `writeVtk(filename)`
+    template <class WriteVtk>
+    void writeTimestepImpl (double time, std::string const& fn, Std::optional<std::string> dir,
+                            bool writeCollection, WriteVtk const& writeVtk) const;
+
     /// Write a series of vtk files in a .pvd ParaView Data file
     void writeFile (std::ofstream& out) const;
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <future>
 #include <iomanip>
 
 #include <dune/vtk/utility/filesystem.hh>
@@ -10,6 +11,30 @@ namespace Dune {
 template <class W>
 void PvdWriter<W>
   ::writeTimestep (double time, std::string const& fn, Std::optional<std::string> dir, bool writeCollection) const
+{
+  writeTimestepImpl(time, fn, dir, writeCollection, [this](std::string const& seq_fn) {
+    vtkWriter_.write(seq_fn);
+  });
+}
+
+
+template <class W>
+std::future<void> PvdWriter<W>
+  ::writeTimestepAsync (double time, std::string const& fn, Std::optional<std::string> dir, bool writeCollection) const
+{
+  std::future<void> future;
+  writeTimestepImpl(time, fn, dir, writeCollection, [this,&future](std::string const& seq_fn) {
+    future = vtkWriter_.writeAsync(seq_fn);
+  });
+  return future;
+}
+
+
+template <class W>
+  template <class WriteVtk>
+void PvdWriter<W>
+  ::writeTimestepImpl (double time, std::string const& fn, Std::optional<std::string> dir,
+                       bool writeCollection, WriteVtk const& writeVtk) const
 {
   auto p = filesystem::path(fn);
   auto name = p.stem();
@@ -31,7 +56,7 @@ void PvdWriter<W>
     ext = ".p" + vtkWriter_.getFileExtension();
 
   timesteps_.emplace_back(time, rel_fn + ext);
-  vtkWriter_.write(seq_fn + ext);
+  writeVtk(seq_fn + ext);
 
   if (commRank == 0 && writeCollection) {
     std::ofstream out(pvd_fn + ".pvd", std::ios_base::ate | std::ios::binary);
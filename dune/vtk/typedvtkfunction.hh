@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cassert>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <dune/common/std/optional.hh>
+#include <dune/vtk/utility/derivedfield.hh>
+#include <dune/vtk/utility/indexedvalues.hh>
+
+#include "vtkfunction.hh"
+#include "vtktypes.hh"
+
+namespace Dune
+{
+  template <class T, int N>
+  class FieldVector;
+
+  template <class T, int N, int M>
+  class FieldMatrix;
+
+  namespace Vtk
+  {
+    /// A grid function with a name and output format, to be attached to a \ref VtkTypedWriter
+    template <class GridFunction>
+    struct Field
+    {
+      GridFunction fct;
+      std::string name;
+      Std::optional<int> ncomps = {};
+      Std::optional<DataTypes> type = {};
+    };
+
+    /// \brief Return a \ref Field of the grid function `fct`
+    /// \see VtkFunction for the meaning of the arguments
+    template <class GridFunction>
+    Field<std::decay_t<GridFunction>> field (GridFunction&& fct, std::string name,
+                                             Std::optional<int> ncomps = {},
+                                             Std::optional<DataTypes> type = {})
+    {
+      return {std::forward<GridFunction>(fct), std::move(name), ncomps, type};
+    }
+
+  } // end namespace Vtk
+
+
+  /// \brief Local function of a \ref TypedVtkFunction
+  /**
+   * Stores the local function of the grid function by value and evaluates it without virtual
+   * calls. The components of the range values are converted directly to the output type.
+   **/
+  template <class GridView, class LocalFunction>
+  class TypedVtkLocalFunction
+  {
+    using Entity = typename GridView::template Codim<0>::Entity;
+    using LocalCoordinate = typename Entity::Geometry::LocalCoordinate;
+
+  public:
+    TypedVtkLocalFunction (LocalFunction const& localFct)
+      : localFct_(localFct)
+    {}
+
+    /// Bind the function to the grid entity
+    void bind (Entity const& entity)
+    {
+      localFct_.bind(entity);
+    }
+
+    /// Unbind from the currently bound entity
+    void unbind ()
+    {
+      localFct_.unbind();
+    }
+
+    /// Evaluate the components [0,ncomps) at the local coordinate `xi` and store them in `values`
+    template <class T>
+    void evaluate (LocalCoordinate const& xi, int ncomps, T* values) const
+    {
+      auto&& y = localFct_(xi);
+      for (int comp = 0; comp < ncomps; ++comp)
+        values[comp] = T(component(comp, y));
+    }
+
+    /// Evaluate the components [0,ncomps) at all the local coordinates `xi`, \see VtkLocalFunction::evaluateAll
+    template <class T>
+    void evaluateAll (std::vector<LocalCoordinate> const& xi, int ncomps, T* values) const
+    {
+      for (std::size_t i = 0; i < xi.size(); ++i)
+        evaluate(xi[i], ncomps, values + i*ncomps);
+    }
+
+    /// A copy of the local function is independent of this function, see \ref clone
+    bool cloneable () const
+    {
+      return true;
+    }
+
+    /// Return a copy of the local function
+    TypedVtkLocalFunction clone () const
+    {
+      return *this;
+    }
+
+  private:
+    // Extract a component of a tensor valued data, row-wise
+    template <class T, int N, int M>
+    static T component (int comp, FieldMatrix<T,N,M> const& mat)
+    {
+      int r = comp / 3;
+      int c = comp % 3;
+      return r < N && c < M ? mat[r][c] : T(0);
+    }
+
+    // Extract a component of a vector valued data
+    template <class T, int N>
+    static T component (int comp, FieldVector<T,N> const& vec)
+    {
+      return comp < N ? vec[comp] : T(0);
+    }
+
+    // Return the scalar value
+    template <class T>
+    static T const& component (int comp, T const& value)
+    {
+      assert(comp == 0);
+      return value;
+    }
+
+  private:
+    LocalFunction localFct_;
+  };
+
+
+  /// \brief Wrapper of a grid function with the interface of \ref VtkFunction, without type erasure
+  /**
+   * Data collectors called with a TypedVtkFunction are instantiated for the concrete local
+   * function, thus its evaluation can be inlined. The name, number of components and output
+   * datatype are determined as for a \ref VtkFunction, see \ref erased.
+   **/
+  template <class GridView, class GridFunction>
+  class TypedVtkFunction
+  {
+    using LocalFunction = std::decay_t<decltype(localFunction(std::declval<GridFunction const&>()))>;
+
+  public:
+    /// Construct from the grid function, name and output format given by `field`
+    TypedVtkFunction (Vtk::Field<GridFunction> const& field)
+      : fct_(field.fct)
+      , erased_(field.fct, field.name, field.ncomps, field.type)
+    {}
+
+    /// Create a LocalFunction
+    friend TypedVtkLocalFunction<GridView, LocalFunction> localFunction (TypedVtkFunction const& self)
+    {
+      return localFunction(self.fct_);
+    }
+
+    /// Return a name associated with the function
+    std::string const& name () const
+    {
+      return erased_.name();
+    }
+
+    /// Return the number of components of the Range
+    int ncomps () const
+    {
+      return erased_.ncomps();
+    }
+
+    /// Return the VTK Datatype associated with the functions range type
+    Vtk::DataTypes type () const
+    {
+      return erased_.type();
+    }
+
+    /// The function is not given by values attached to grid entities
+    Vtk::IndexedValues const* indexedValues () const
+    {
+      return nullptr;
+    }
+
+    /// The function is not computed from other functions
+    Vtk::DerivedField const* derived () const
+    {
+      return nullptr;
+    }
+
+    /// Return the type-erased \ref VtkFunction of the same grid function
+    VtkFunction<GridView> const& erased () const
+    {
+      return erased_;
+    }
+
+  private:
+    GridFunction fct_;
+    VtkFunction<GridView> erased_;
+  };
+
+} // end namespace Dune
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Dune
+{
+  namespace Vtk
+  {
+    /// The raw arrays of an unstructured grid partition that can be merged with other partitions
+    /**
+     * The arrays are stored as bytes in the order given by \ref ArrayIndex, followed by
+     * the point-data and cell-data arrays. All partitions that are merged must provide
+     * the same list of arrays with the same value types.
+     **/
+    struct AggregatedPiece
+    {
+      enum ArrayIndex {
+        POINTS,           // point coordinates, 3 components
+        CONNECTIVITY,     // std::int64_t
+        OFFSETS,          // std::int64_t
+        TYPES,            // std::uint8_t
+        POINT_IDS,        // std::uint64_t, might be empty
+        NUM_GRID_ARRAYS
+      };
+
+      std::uint64_t numPoints = 0;
+      std::uint64_t numCells = 0;
+      std::vector<std::vector<unsigned char>> arrays;
+
+      /// Append the `values` as new array
+      template <class T>
+      void push_back (std::vector<T> const& values)
+      {
+        auto first = reinterpret_cast<unsigned char const*>(values.data());
+        arrays.emplace_back(first, first + values.size()*sizeof(T));
+      }
+
+      /// Append the points and cells of `other` and shift the point indices and offsets of its cells
+      void merge (AggregatedPiece const& other)
+      {
+        if (arrays.empty()) {
+          *this = other;
+          return;
+        }
+
+        assert(arrays.size() == other.arrays.size());
+        std::size_t first = arrays[CONNECTIVITY].size();
+        std::int64_t connectivityShift = std::int64_t(first / sizeof(std::int64_t));
+        for (std::size_t i = 0; i < arrays.size(); ++i)
+          arrays[i].insert(arrays[i].end(), other.arrays[i].begin(), other.arrays[i].end());
+
+        shift(arrays[CONNECTIVITY], first, std::int64_t(numPoints));
+        shift(arrays[OFFSETS], arrays[OFFSETS].size() - other.arrays[OFFSETS].size(), connectivityShift);
+
+        numPoints += other.numPoints;
+        numCells += other.numCells;
+      }
+
+      /// Write the piece into a flat vector of bytes
+      std::vector<unsigned char> serialize () const
+      {
+        std::vector<std::uint64_t> header{numPoints, numCells, arrays.size()};
+        for (auto const& a : arrays)
+          header.push_back(a.size());
+
+        std::vector<unsigned char> bytes(header.size()*sizeof(std::uint64_t));
+        std::memcpy(bytes.data(), header.data(), bytes.size());
+        for (auto const& a : arrays)
+          bytes.insert(bytes.end(), a.begin(), a.end());
+        return bytes;
+      }
+
+      /// Read a piece from a flat vector of bytes, created by \ref serialize
+      static AggregatedPiece deserialize (std::vector<unsigned char> const& bytes)
+      {
+        AggregatedPiece piece;
+        unsigned char const* pos = bytes.data();
+        auto read = [&pos]() { std::uint64_t value; std::memcpy(&value, pos, sizeof(value)); pos += sizeof(value); return value; };
+
+        piece.numPoints = read();
+        piece.numCells = read();
+        std::vector<std::uint64_t> sizes(read());
+        for (auto& size : sizes)
+          size = read();
+
+        for (auto size : sizes) {
+          piece.arrays.emplace_back(pos, pos + size);
+          pos += size;
+        }
+        assert(pos == bytes.data() + bytes.size());
+        return piece;
+      }
+
+    private:
+      // Add `value` to all std::int64_t values in `bytes`, starting at byte `first`
+      static void shift (std::vector<unsigned char>& bytes, std::size_t first, std::int64_t value)
+      {
+        for (std::size_t i = first; i < bytes.size(); i += sizeof(std::int64_t)) {
+          std::int64_t v;
+          std::memcpy(&v, bytes.data() + i, sizeof(v));
+          v += value;
+          std::memcpy(bytes.data() + i, &v, sizeof(v));
+        }
+      }
+    };
+
+  } // end namespace Vtk
+} // end namespace Dune
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__has_include)
+  #if __cplusplus >= 201703L && __has_include(<charconv>)
+    #include <charconv>
+  #endif
+#endif
+
+#if __cpp_lib_to_chars >= 201611L
+  #define DUNE_VTK_HAVE_TO_CHARS 1
+#endif
+
+#include <locale>
+#include <sstream>
+
+#include <dune/common/exceptions.hh>
+
+namespace Dune
+{
+  namespace Vtk
+  {
+    namespace Impl
+    {
+      // print 8-bit integers as numbers, not as characters
+      template <class T>
+      T printableValue (T const& t) { return t; }
+
+      inline int printableValue (signed char c) { return c; }
+      inline unsigned int printableValue (unsigned char c) { return c; }
+
+      inline bool isSpace (char c)
+      {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\v';
+      }
+
+#if DUNE_VTK_HAVE_TO_CHARS
+      template <class T, std::enable_if_t<std::is_floating_point<T>::value, int> = 0>
+      char* toChars (char* first, char* last, T value, int precision)
+      {
+        return std::to_chars(first, last, value, std::chars_format::general, precision).ptr;
+      }
+
+      template <class T, std::enable_if_t<std::is_integral<T>::value, int> = 0>
+      char* toChars (char* first, char* last, T value, int /*precision*/)
+      {
+        return std::to_chars(first, last, printableValue(value)).ptr;
+      }
+
+      // Read values with std::from_chars. Return the position of the first invalid value, or `last`.
+      template <class T>
+      char const* parseValuesImpl (char const* first, char const* last, std::vector<T>& values, std::true_type)
+      {
+        using S = std::conditional_t<(sizeof(T) <= 1),
+          std::conditional_t<std::is_signed<T>::value, int, unsigned int>, T>; // read chars as ints
+
+        for (;;) {
+          while (first != last && isSpace(*first))
+            ++first;
+          if (first == last)
+            return last;
+
+          char const* token = first;
+          if (*first == '+')
+            ++first;
+
+          S value{};
+          auto result = std::from_chars(first, last, value);
+          if (result.ec != std::errc{})
+            return token;
+          values.push_back(T(value));
+          first = result.ptr;
+        }
+      }
+#endif
+
+      // Read values with the classic-locale stream operator, e.g., for non-arithmetic types.
+      // Return the position of the first invalid value, or `last`.
+      template <class T>
+      char const* parseValuesImpl (char const* first, char const* last, std::vector<T>& values, std::false_type)
+      {
+        using S = std::conditional_t<(sizeof(T) <= 1), std::uint16_t, T>; // read chars as ints
+        std::istringstream stream(std::string(first, last));
+        stream.imbue(std::locale::classic());
+        for (;;) {
+          stream >> std::ws;
+          if (stream.eof())
+            return last;
+
+          auto pos = stream.tellg();
+          S value;
+          if (!(stream >> value))
+            return first + std::streamoff(pos);
+          values.push_back(T(value));
+        }
+      }
+    } // end namespace Impl
+
+
+    /// \brief Write the ascii representation of `n` values into the `buffer`
+    /**
+     * The values are separated by a space, with a newline after every `valuesPerLine`
+     * values. Floating point values are written with `precision` significant digits,
+     * the same as `std::ostream::operator<<` with the classic locale would do. If
+     * `std::to_chars` is available, it is used instead of the stream formatting.
+     **/
+    template <class T>
+    void formatValues (std::string& buffer, T const* values, std::size_t n,
+                       int precision, std::size_t valuesPerLine = 6)
+    {
+#if DUNE_VTK_HAVE_TO_CHARS
+      // sign, digits, decimal point, exponent, and separator
+      std::size_t maxLength = 32 + std::size_t(std::max(precision, 0));
+      buffer.resize(n * maxLength);
+
+      char* first = &buffer[0];
+      char* pos = first;
+      char* last = first + buffer.size();
+      for (std::size_t i = 0; i < n; ++i) {
+        pos = Impl::toChars(pos, last, values[i], precision);
+        *pos++ = ((i+1) % valuesPerLine != 0 ? ' ' : '\n');
+      }
+      buffer.resize(std::size_t(pos - first));
+#else
+      std::ostringstream out;
+      out.imbue(std::locale::classic());
+      out.precision(precision);
+      for (std::size_t i = 0; i < n; ++i)
+        out << Impl::printableValue(values[i]) << ((i+1) % valuesPerLine != 0 ? ' ' : '\n');
+      buffer = out.str();
+#endif
+    }
+
+
+    /// \brief Read whitespace separated values from the character range [first,last) and append
+    /// these to the vector `values`.
+    /**
+     * An IOError is thrown at the first character sequence that is not a valid value, with
+     * its position in the text, i.e., `offset` plus its distance to `first`. For arithmetic
+     * types, `std::from_chars` is used if available. Otherwise, the values are read with
+     * `std::istream::operator>>` in the classic locale.
+     **/
+    template <class T>
+    void parseValues (char const* first, char const* last, std::vector<T>& values, std::size_t offset = 0)
+    {
+#if DUNE_VTK_HAVE_TO_CHARS
+      using UseFromChars = std::integral_constant<bool,
+        std::is_arithmetic<T>::value && !std::is_same<T,bool>::value>;
+#else
+      using UseFromChars = std::false_type;
+#endif
+      char const* pos = Impl::parseValuesImpl(first, last, values, UseFromChars{});
+      if (pos != last) {
+        char const* end = std::find_if(pos, std::min(last, pos + 32), Impl::isSpace);
+        DUNE_THROW(IOError, "Invalid value '" << std::string(pos, end) << "' at offset "
+          << offset + std::size_t(pos - first) << " of the data array.");
+      }
+    }
+
+  } // end namespace Vtk
+} // end namespace Dune
+
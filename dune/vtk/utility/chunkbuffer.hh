@@ -0,0 +1,61 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace Dune
+{
+  namespace Vtk
+  {
+    /// Collect values in a buffer of fixed size and pass each full chunk to a sink
+    /**
+     * The `sink` is a callable with signature `void(T const* data, std::size_t n)`
+     * that is called with consecutive chunks of at most `chunkSize` values. Call
+     * \ref flush() after the last value is pushed.
+     **/
+    template <class T, class Sink>
+    class ChunkBuffer
+    {
+    public:
+      ChunkBuffer (Sink& sink, std::size_t chunkSize)
+        : sink_(sink)
+        , chunkSize_(std::max<std::size_t>(chunkSize, 1u))
+      {
+        buffer_.reserve(chunkSize_);
+      }
+
+      /// Append a value and pass the buffer to the sink if it is full
+      void push_back (T const& value)
+      {
+        buffer_.push_back(value);
+        if (buffer_.size() == chunkSize_)
+          flush();
+      }
+
+      /// Pass the remaining values to the sink
+      void flush ()
+      {
+        if (!buffer_.empty())
+          sink_(buffer_.data(), buffer_.size());
+        buffer_.clear();
+      }
+
+    private:
+      Sink& sink_;
+      std::size_t chunkSize_;
+      std::vector<T> buffer_;
+    };
+
+
+    /// Pass the values of the vector `values` in chunks of at most `chunkSize` values to the `sink`
+    template <class T, class Sink>
+    void passChunks (std::vector<T> const& values, Sink& sink, std::size_t chunkSize)
+    {
+      chunkSize = std::max<std::size_t>(chunkSize, 1u);
+      for (std::size_t i = 0; i < values.size(); i += chunkSize)
+        sink(values.data() + i, std::min(chunkSize, values.size() - i));
+    }
+
+  } // end namespace Vtk
+} // end namespace Dune
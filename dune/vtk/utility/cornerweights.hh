@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+#include <dune/geometry/type.hh>
+
+namespace Dune
+{
+  namespace Vtk
+  {
+    /// \brief Return the values of the linear shape functions of the corners of the reference
+    /// element of type `t` at the local coordinate `x`
+    /**
+     * The shape functions are the barycentric coordinates on simplices, the multilinear
+     * functions on cubes, their products on prisms, and the rational functions on pyramids.
+     * The corners are numbered as in the Dune reference element.
+     **/
+    template <class LocalCoordinate>
+    std::vector<double> cornerWeights (GeometryType const& t, LocalCoordinate const& x)
+    {
+      const int dim = int(x.size());
+      std::vector<double> w;
+      if (t.isSimplex()) {
+        double w0 = 1.0;
+        for (int d = 0; d < dim; ++d)
+          w0 -= x[d];
+        w.push_back(w0);
+        for (int d = 0; d < dim; ++d)
+          w.push_back(x[d]);
+      } else if (t.isCube()) {
+        for (int i = 0; i < (1 << dim); ++i) {
+          double wi = 1.0;
+          for (int d = 0; d < dim; ++d)
+            wi *= (i & (1 << d)) ? x[d] : 1.0 - x[d];
+          w.push_back(wi);
+        }
+      } else if (t.isPrism()) {
+        double tri[3] = {1.0 - x[0] - x[1], x[0], x[1]};
+        for (int k = 0; k < 2; ++k)
+          for (int i = 0; i < 3; ++i)
+            w.push_back(tri[i] * (k == 0 ? 1.0 - x[2] : x[2]));
+      } else if (t.isPyramid()) {
+        double z = x[2];
+        if (z < 1.0) {
+          double a = 1.0 - x[0] - z, b = 1.0 - x[1] - z;
+          w = {a*b/(1.0-z), x[0]*b/(1.0-z), a*x[1]/(1.0-z), x[0]*x[1]/(1.0-z), z};
+        } else {
+          w = {0.0, 0.0, 0.0, 0.0, 1.0};
+        }
+      }
+      return w;
+    }
+
+  } // end namespace Vtk
+} // end namespace Dune
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Dune
+{
+  namespace Vtk
+  {
+    /// \brief A field computed point-wise from other fields attached to the same writer
+    /**
+     * The sources are referred to by name. All sources must have the same number of
+     * components. The values are computed by \ref apply from the flat arrays of the sources,
+     * as written to the file, i.e., vectors extended to 3 and tensors to 3x3 components.
+     * Use the functions \ref magnitude, \ref component, \ref linearCombination, and
+     * \ref unitConversion to create a DerivedField.
+     **/
+    class DerivedField
+    {
+    public:
+      enum Operation {
+        MAGNITUDE,          //< Euclidean norm of all components of the source
+        COMPONENT,          //< a single component of the source
+        LINEAR_COMBINATION  //< shift + sum_i coefficients[i] * sources[i], for all components
+      };
+
+    public:
+      DerivedField (Operation op, std::vector<std::string> sources,
+                    std::vector<double> coefficients = {}, double shift = 0.0, int comp = 0)
+        : op_(op)
+        , sources_(std::move(sources))
+        , coefficients_(std::move(coefficients))
+        , shift_(shift)
+        , comp_(comp)
+      {
+        assert(!sources_.empty());
+        assert(op_ != LINEAR_COMBINATION || coefficients_.size() == sources_.size());
+      }
+
+      /// Return the operation applied to the sources
+      Operation operation () const
+      {
+        return op_;
+      }
+
+      /// Return the names of the source fields
+      std::vector<std::string> const& sources () const
+      {
+        return sources_;
+      }
+
+      /// Return the extracted component, for \ref COMPONENT
+      int comp () const
+      {
+        return comp_;
+      }
+
+      /// Return the number of components of the result, for sources with `ncomps` components
+      int ncomps (int ncomps) const
+      {
+        return op_ == LINEAR_COMBINATION ? ncomps : 1;
+      }
+
+      /// \brief Compute the values at `n` points from the `sources` with `ncomps` components each
+      /**
+       * `sources[s]` points to the `n*ncomps` values of the source field s. The result is
+       * stored in `out`, which must provide space for `n*ncomps(ncomps)` values. The loops run
+       * over contiguous arrays, so they can be vectorized by the compiler.
+       **/
+      void apply (double const* const* sources, std::size_t n, int ncomps, double* out) const
+      {
+        switch (op_) {
+          case MAGNITUDE:
+            switch (ncomps) {
+              case 1:  magnitude<1>(sources[0], n, out); break;
+              case 3:  magnitude<3>(sources[0], n, out); break;
+              case 9:  magnitude<9>(sources[0], n, out); break;
+              default: magnitude(sources[0], n, ncomps, out); break;
+            }
+            break;
+          case COMPONENT:
+            assert(comp_ < ncomps);
+            for (std::size_t k = 0; k < n; ++k)
+              out[k] = sources[0][k*ncomps + comp_];
+            break;
+          case LINEAR_COMBINATION: {
+            const std::size_t size = n * std::size_t(ncomps);
+            for (std::size_t i = 0; i < size; ++i)
+              out[i] = shift_;
+            for (std::size_t s = 0; s < sources_.size(); ++s) {
+              double const* x = sources[s];
+              const double a = coefficients_[s];
+              for (std::size_t i = 0; i < size; ++i)
+                out[i] += a * x[i];
+            }
+            break;
+          }
+        }
+      }
+
+    private:
+      template <int N>
+      static void magnitude (double const* x, std::size_t n, double* out)
+      {
+        for (std::size_t k = 0; k < n; ++k) {
+          double sum = 0.0;
+          for (int c = 0; c < N; ++c)
+            sum += x[k*N + c] * x[k*N + c];
+          out[k] = std::sqrt(sum);
+        }
+      }
+
+      static void magnitude (double const* x, std::size_t n, int ncomps, double* out)
+      {
+        for (std::size_t k = 0; k < n; ++k) {
+          double sum = 0.0;
+          for (int c = 0; c < ncomps; ++c)
+            sum += x[k*ncomps + c] * x[k*ncomps + c];
+          out[k] = std::sqrt(sum);
+        }
+      }
+
+    private:
+      Operation op_;
+      std::vector<std::string> sources_;
+      std::vector<double> coefficients_;
+      double shift_;
+      int comp_;
+    };
+
+
+    /// The Euclidean norm of the field `source`, e.g., the magnitude of a velocity
+    inline DerivedField magnitude (std::string source)
+    {
+      return {DerivedField::MAGNITUDE, {std::move(source)}};
+    }
+
+    /// The component `comp` of the field `source`, e.g., the pressure in a state vector
+    inline DerivedField component (std::string source, int comp)
+    {
+      return {DerivedField::COMPONENT, {std::move(source)}, {}, 0.0, comp};
+    }
+
+    /// The sum `shift + a_0*f_0 + a_1*f_1 + ...` of the `terms` (a_i, name of f_i)
+    inline DerivedField linearCombination (std::vector<std::pair<double,std::string>> terms, double shift = 0.0)
+    {
+      std::vector<std::string> sources;
+      std::vector<double> coefficients;
+      for (auto& t : terms) {
+        coefficients.push_back(t.first);
+        sources.push_back(std::move(t.second));
+      }
+      return {DerivedField::LINEAR_COMBINATION, std::move(sources), std::move(coefficients), shift};
+    }
+
+    /// The field `source` converted to another unit by `factor*source + offset`
+    inline DerivedField unitConversion (std::string source, double factor, double offset = 0.0)
+    {
+      return linearCombination({{factor, std::move(source)}}, offset);
+    }
+
+  } // end namespace Vtk
+} // end namespace Dune
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <dune/common/std/type_traits.hh>
+#include <dune/vtk/vtktypes.hh>
+
+namespace Dune
+{
+  template <class T, int N>
+  class FieldVector;
+
+  template <class T, int N, int M>
+  class FieldMatrix;
+
+  namespace Vtk
+  {
+    namespace Impl
+    {
+      // Shape of a block of values stored in a container
+      template <class T>
+      struct BlockInfo
+      {
+        using field_type = T;
+        static constexpr int rows = 1, cols = 1;
+        static constexpr bool matrix = false;
+      };
+
+      template <class T, int N>
+      struct BlockInfo<FieldVector<T,N>>
+      {
+        using field_type = T;
+        static constexpr int rows = N, cols = 1;
+        static constexpr bool matrix = false;
+      };
+
+      template <class T, int N, int M>
+      struct BlockInfo<FieldMatrix<T,N,M>>
+      {
+        using field_type = T;
+        static constexpr int rows = N, cols = M;
+        static constexpr bool matrix = true;
+      };
+
+      // The VTK datatype with the same representation as `T`, or UNKNOWN
+      template <class T>
+      constexpr DataTypes dataTypeOf ()
+      {
+        return std::is_same<T,bool>::value ? UNKNOWN
+          : std::is_integral<T>::value
+            ? (sizeof(T) == 1 ? (std::is_signed<T>::value ? INT8 : UINT8)
+             : sizeof(T) == 2 ? (std::is_signed<T>::value ? INT16 : UINT16)
+             : sizeof(T) == 4 ? (std::is_signed<T>::value ? INT32 : UINT32)
+             : sizeof(T) == 8 ? (std::is_signed<T>::value ? INT64 : UINT64) : UNKNOWN)
+          : std::is_floating_point<T>::value
+            ? (sizeof(T) == 4 ? FLOAT32 : sizeof(T) == 8 ? FLOAT64 : UNKNOWN)
+          : UNKNOWN;
+      }
+
+      template <class C>
+      using ContainerBlock = std::decay_t<decltype(std::declval<C const&>()[std::size_t(0)])>;
+
+      template <class C>
+      using ContainerSize = decltype(std::size_t(std::declval<C const&>().size()));
+
+      template <class C, bool = Std::is_detected<ContainerBlock,C>::value && Std::is_detected<ContainerSize,C>::value>
+      struct IsIndexedContainerImpl : std::false_type {};
+
+      template <class C>
+      struct IsIndexedContainerImpl<C, true>
+      {
+        using Block = ContainerBlock<C>;
+        using Info = BlockInfo<Block>;
+        using T = typename Info::field_type;
+        static constexpr bool value = dataTypeOf<T>() != UNKNOWN
+          && sizeof(Block) == sizeof(T) * Info::rows * Info::cols
+          && std::is_lvalue_reference<decltype(std::declval<C const&>()[std::size_t(0)])>::value;
+      };
+
+    } // end namespace Impl
+
+
+    /// \brief Whether `C` is a container of values that can be wrapped by \ref IndexedValues
+    /**
+     * The container must provide `size()` and an `operator[]` returning a reference to a
+     * number or to a `FieldVector` or `FieldMatrix` of numbers, stored contiguously, e.g.,
+     * `std::vector<double>` or `BlockVector<FieldVector<double,3>>`.
+     **/
+    template <class C>
+    using IsIndexedContainer = Impl::IsIndexedContainerImpl<std::decay_t<C>>;
+
+
+    /// \brief A view to values attached to the grid entities of one codimension, stored in a
+    /// contiguous container in the order of the entity indices
+    /**
+     * The view stores a pointer to the values, thus the container must not be destroyed or
+     * resized while the view is in use. Blocks of values are mapped to the flat components of
+     * the VTK output in the same way as the range values of a grid function, i.e., vectors
+     * are written component-wise and matrices row-wise, extended by zeros to 3 or 3x3 values.
+     **/
+    class IndexedValues
+    {
+    public:
+      /// Construct a view to the `values`, indexed by the entities of codimension `codim`
+      template <class Container,
+        std::enable_if_t<IsIndexedContainer<Container>::value, int> = 0>
+      IndexedValues (Container const& values, int codim)
+        : size_(values.size())
+        , codim_(codim)
+      {
+        using Info = Impl::BlockInfo<Impl::ContainerBlock<Container>>;
+        using T = typename Info::field_type;
+
+        data_ = size_ > 0 ? static_cast<void const*>(&values[0]) : nullptr;
+        datatype_ = Impl::dataTypeOf<T>();
+        blockSize_ = Info::rows * Info::cols;
+        for (int comp = 0; comp < 9; ++comp) {
+          if (Info::matrix) {
+            int r = comp / 3, c = comp % 3;
+            components_[comp] = r < Info::rows && c < Info::cols ? r*Info::cols + c : -1;
+          } else {
+            components_[comp] = comp < blockSize_ ? comp : -1;
+          }
+        }
+      }
+
+      /// The view does not extend the lifetime of temporary containers
+      template <class Container,
+        std::enable_if_t<!std::is_lvalue_reference<Container>::value && IsIndexedContainer<Container>::value, int> = 0>
+      IndexedValues (Container&& values, int codim) = delete;
+
+      /// Return the number of blocks
+      std::size_t size () const
+      {
+        return size_;
+      }
+
+      /// Return the codimension of the entities the values are attached to
+      int codim () const
+      {
+        return codim_;
+      }
+
+      /// Return the number of values per entity
+      int blockSize () const
+      {
+        return blockSize_;
+      }
+
+      /// Return the datatype of the stored values
+      DataTypes datatype () const
+      {
+        return datatype_;
+      }
+
+      /// \brief Copy the components [0,ncomps) of the blocks `indices` to `out`, converted to `T`
+      /**
+       * The values of block `indices[k]` are stored in `out[k*ncomps + comp]`. Components
+       * that are not stored in the block are set to zero.
+       **/
+      template <class T, class Index>
+      void gather (std::vector<Index> const& indices, int ncomps, T* out) const
+      {
+        gather(indices.data(), indices.size(), ncomps, out);
+      }
+
+      /// Copy the components of the `n` blocks `indices[0,n)` to `out`, \see gather
+      template <class T, class Index>
+      void gather (Index const* indices, std::size_t n, int ncomps, T* out) const
+      {
+        assert(ncomps <= 9);
+        switch (datatype_) {
+          case INT8:    gatherImpl<std::int8_t>(indices, n, ncomps, out); break;
+          case UINT8:   gatherImpl<std::uint8_t>(indices, n, ncomps, out); break;
+          case INT16:   gatherImpl<std::int16_t>(indices, n, ncomps, out); break;
+          case UINT16:  gatherImpl<std::uint16_t>(indices, n, ncomps, out); break;
+          case INT32:   gatherImpl<std::int32_t>(indices, n, ncomps, out); break;
+          case UINT32:  gatherImpl<std::uint32_t>(indices, n, ncomps, out); break;
+          case INT64:   gatherImpl<std::int64_t>(indices, n, ncomps, out); break;
+          case UINT64:  gatherImpl<std::uint64_t>(indices, n, ncomps, out); break;
+          case FLOAT32: gatherImpl<float>(indices, n, ncomps, out); break;
+          case FLOAT64: gatherImpl<double>(indices, n, ncomps, out); break;
+          default:
+            assert(false && "Unsupported datatype of indexed values");
+        }
+      }
+
+    private:
+      template <class S, class T, class Index>
+      void gatherImpl (Index const* indices, std::size_t n, int ncomps, T* out) const
+      {
+        S const* data = static_cast<S const*>(data_);
+        const std::size_t blockSize = std::size_t(blockSize_);
+        if (ncomps == blockSize_ && blockSize_ <= 3) {
+          // the components of the block are the output components
+          for (std::size_t k = 0; k < n; ++k) {
+            assert(std::size_t(indices[k]) < size_);
+            S const* block = data + blockSize * std::size_t(indices[k]);
+            for (std::size_t comp = 0; comp < blockSize; ++comp)
+              out[k*blockSize + comp] = T(block[comp]);
+          }
+          return;
+        }
+
+        for (std::size_t k = 0; k < n; ++k) {
+          assert(std::size_t(indices[k]) < size_);
+          S const* block = data + blockSize * std::size_t(indices[k]);
+          for (int comp = 0; comp < ncomps; ++comp) {
+            int j = components_[comp];
+            out[k*ncomps + comp] = j >= 0 ? T(block[j]) : T(0);
+          }
+        }
+      }
+
+    private:
+      void const* data_ = nullptr;
+      std::size_t size_ = 0;
+      int codim_ = 0;
+      int blockSize_ = 1;
+      DataTypes datatype_ = UNKNOWN;
+      std::array<int,9> components_;  //< position in the block of each output component, or -1
+    };
+
+  } // end namespace Vtk
+} // end namespace Dune
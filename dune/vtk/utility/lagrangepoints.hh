@@ -0,0 +1,275 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/vtk/vtktypes.hh>
+
+namespace Dune
+{
+  namespace Vtk
+  {
+    /// Integer coordinates of a node of a Lagrange cell of order p, i.e., p times the
+    /// coordinates in the VTK reference cell.
+    using LatticePoint = std::array<int,3>;
+
+    namespace Impl
+    {
+      inline LatticePoint latticePoint (LatticePoint const& a, int s, LatticePoint const& u)
+      {
+        return {{a[0] + s*u[0], a[1] + s*u[1], a[2] + s*u[2]}};
+      }
+
+      inline LatticePoint latticeDiff (LatticePoint const& a, LatticePoint const& b)
+      {
+        return {{a[0] - b[0], a[1] - b[1], a[2] - b[2]}};
+      }
+
+      // Nodes of a triangle of order p with corners a, a+p*u, a+p*v: first the corners, then the
+      // nodes on the edges in counterclockwise direction, then the interior nodes recursively.
+      inline void triangleNodes (int p, LatticePoint const& a, LatticePoint const& u,
+                                 LatticePoint const& v, std::vector<LatticePoint>& nodes)
+      {
+        if (p < 0)
+          return;
+        if (p == 0) {
+          nodes.push_back(a);
+          return;
+        }
+
+        LatticePoint b = latticePoint(a, p, u), c = latticePoint(a, p, v);
+        nodes.push_back(a);
+        nodes.push_back(b);
+        nodes.push_back(c);
+        for (int t = 1; t < p; ++t)
+          nodes.push_back(latticePoint(a, t, u));
+        for (int t = 1; t < p; ++t)
+          nodes.push_back(latticePoint(b, t, latticeDiff(v, u)));
+        for (int t = 1; t < p; ++t)
+          nodes.push_back(latticePoint(c, -t, v));
+
+        LatticePoint inner = latticePoint(latticePoint(a, 1, u), 1, v);
+        triangleNodes(p-3, inner, u, v, nodes);
+      }
+
+      // Nodes of a tetrahedron of order p with corners a, a+p*u, a+p*v, a+p*w: the corners,
+      // the edges, the interior nodes of the faces (0,1,3), (1,2,3), (2,0,3), (0,2,1), and the
+      // interior nodes recursively.
+      inline void tetrahedronNodes (int p, LatticePoint const& a, LatticePoint const& u,
+                                    LatticePoint const& v, LatticePoint const& w,
+                                    std::vector<LatticePoint>& nodes)
+      {
+        if (p < 0)
+          return;
+        if (p == 0) {
+          nodes.push_back(a);
+          return;
+        }
+
+        std::array<LatticePoint,4> x{{a, latticePoint(a, p, u), latticePoint(a, p, v), latticePoint(a, p, w)}};
+        for (auto const& corner : x)
+          nodes.push_back(corner);
+
+        static const int edges[6][2] = {{0,1}, {1,2}, {2,0}, {0,3}, {1,3}, {2,3}};
+        for (auto const& e : edges) {
+          LatticePoint dir = latticeDiff(x[e[1]], x[e[0]]);
+          for (int t = 1; t < p; ++t)
+            nodes.push_back({{x[e[0]][0] + t*dir[0]/p, x[e[0]][1] + t*dir[1]/p, x[e[0]][2] + t*dir[2]/p}});
+        }
+
+        static const int faces[4][3] = {{0,1,3}, {1,2,3}, {2,0,3}, {0,2,1}};
+        for (auto const& f : faces) {
+          LatticePoint e1 = latticeDiff(x[f[1]], x[f[0]]), e2 = latticeDiff(x[f[2]], x[f[0]]);
+          for (int i = 0; i < 3; ++i) {
+            e1[i] /= p;
+            e2[i] /= p;
+          }
+          triangleNodes(p-3, latticePoint(latticePoint(x[f[0]], 1, e1), 1, e2), e1, e2, nodes);
+        }
+
+        LatticePoint inner = latticePoint(latticePoint(latticePoint(a, 1, u), 1, v), 1, w);
+        tetrahedronNodes(p-4, inner, u, v, w, nodes);
+      }
+
+      // Position of the node (i,j,k) of a quadrilateral (n=2) or hexahedron (n=3) of order p in
+      // the VTK node ordering: corners, edges, faces, interior, each in lexicographic order.
+      inline int tensorNodeIndex (int n, int p, int i, int j, int k)
+      {
+        bool ibdy = (i == 0 || i == p);
+        bool jbdy = (j == 0 || j == p);
+        bool kbdy = (n == 2 || k == 0 || k == p);
+        int nbdy = int(ibdy) + int(jbdy) + int(kbdy);
+        int m = p-1;
+        int numCorners = n == 2 ? 4 : 8;
+
+        if (nbdy == 3) // corner
+          return (i ? (j ? 2 : 1) : (j ? 3 : 0)) + (k ? 4 : 0);
+
+        int offset = numCorners;
+        if (nbdy == 2) { // edge
+          if (!ibdy)
+            return (i-1) + (j ? 2*m : 0) + (k ? 4*m : 0) + offset;
+          if (!jbdy)
+            return (j-1) + (i ? m : 3*m) + (k ? 4*m : 0) + offset;
+          offset += 8*m;
+          return (k-1) + m*(i ? (j ? 3 : 1) : (j ? 2 : 0)) + offset;
+        }
+
+        offset += (n == 2 ? 4 : 12) * m;
+        if (n == 2) // interior of the quadrilateral
+          return (i-1) + m*(j-1) + offset;
+
+        if (nbdy == 1) { // face
+          if (ibdy)
+            return (j-1) + m*(k-1) + (i ? m*m : 0) + offset;
+          offset += 2*m*m;
+          if (jbdy)
+            return (i-1) + m*(k-1) + (j ? m*m : 0) + offset;
+          offset += 2*m*m;
+          return (i-1) + m*(j-1) + (k ? m*m : 0) + offset;
+        }
+
+        offset += 6*m*m;
+        return (i-1) + m*((j-1) + m*(k-1)) + offset;
+      }
+
+      // Position of the node (i,j,k), with i+j <= p, of a wedge of order p in the VTK node
+      // ordering: corners, edges of the bottom and the top triangle, vertical edges, interior
+      // nodes of the triangles, of the quadrilaterals j=0, i+j=p, i=0, and the interior nodes.
+      // The interior nodes of a triangle are ordered lexicographically with i running slowest.
+      inline int wedgeNodeIndex (int p, int i, int j, int k)
+      {
+        bool ibdy = (i == 0);
+        bool jbdy = (j == 0);
+        bool ijbdy = (i + j == p);
+        bool kbdy = (k == 0 || k == p);
+        int nbdy = int(ibdy) + int(jbdy) + int(ijbdy) + int(kbdy);
+        int m = p-1;
+
+        // position of the interior node (i,j) in a triangle
+        auto triangleIndex = [p](int i, int j) { return (p-1)*(i-1) - i*(i-1)/2 + j-1; };
+
+        if (nbdy == 3) // corner
+          return (ibdy && jbdy ? 0 : jbdy && ijbdy ? 1 : 2) + (k ? 3 : 0);
+
+        int offset = 6;
+        if (nbdy == 2) { // edge
+          if (!kbdy)
+            return (k-1) + m*(ibdy && jbdy ? 0 : jbdy && ijbdy ? 1 : 2) + offset + 6*m;
+          offset += (k ? 3*m : 0);
+          if (jbdy)
+            return (i-1) + offset;
+          if (ijbdy)
+            return (j-1) + m + offset;
+          return (p-j-1) + 2*m + offset;
+        }
+
+        offset += 9*m;
+        int nt = m*(m-1)/2; // interior nodes of a triangle
+        if (nbdy == 1) { // face
+          if (kbdy)
+            return triangleIndex(i,j) + (k ? nt : 0) + offset;
+          offset += 2*nt;
+          if (jbdy)
+            return (i-1) + m*(k-1) + offset;
+          if (ijbdy)
+            return (p-i-1) + m*(k-1) + m*m + offset;
+          return (j-1) + m*(k-1) + 2*m*m + offset;
+        }
+
+        offset += 2*nt + 3*m*m;
+        return triangleIndex(i,j) + nt*(k-1) + offset;
+      }
+
+    } // end namespace Impl
+
+
+    /// \brief Return the nodes of the VTK Lagrange cell `type` of order `p` in VTK node ordering
+    /**
+     * The nodes are given as \ref LatticePoint, i.e., p times the coordinates in the VTK
+     * reference cell with the corners of the corresponding linear VTK cell. Supported are
+     * LAGRANGE_CURVE, LAGRANGE_TRIANGLE, LAGRANGE_QUADRILATERAL, LAGRANGE_TETRAHEDRON,
+     * LAGRANGE_HEXAHEDRON, and LAGRANGE_WEDGE. For other cell types, e.g., pyramids, a
+     * NotImplemented exception is thrown.
+     **/
+    inline std::vector<LatticePoint> lagrangeNodes (std::uint8_t type, int p)
+    {
+      assert(p >= 1);
+      std::vector<LatticePoint> nodes;
+      LatticePoint o{{0,0,0}}, ex{{1,0,0}}, ey{{0,1,0}}, ez{{0,0,1}};
+      switch (type) {
+        case LAGRANGE_CURVE:
+          nodes.push_back(o);
+          nodes.push_back({{p,0,0}});
+          for (int t = 1; t < p; ++t)
+            nodes.push_back({{t,0,0}});
+          break;
+        case LAGRANGE_TRIANGLE:
+          Impl::triangleNodes(p, o, ex, ey, nodes);
+          break;
+        case LAGRANGE_TETRAHEDRON:
+          Impl::tetrahedronNodes(p, o, ex, ey, ez, nodes);
+          break;
+        case LAGRANGE_QUADRILATERAL:
+          nodes.resize((p+1)*(p+1));
+          for (int j = 0; j <= p; ++j)
+            for (int i = 0; i <= p; ++i)
+              nodes[Impl::tensorNodeIndex(2,p,i,j,0)] = {{i,j,0}};
+          break;
+        case LAGRANGE_HEXAHEDRON:
+          nodes.resize((p+1)*(p+1)*(p+1));
+          for (int k = 0; k <= p; ++k)
+            for (int j = 0; j <= p; ++j)
+              for (int i = 0; i <= p; ++i)
+                nodes[Impl::tensorNodeIndex(3,p,i,j,k)] = {{i,j,k}};
+          break;
+        case LAGRANGE_WEDGE:
+          nodes.resize((p+1)*(p+2)/2*(p+1));
+          for (int k = 0; k <= p; ++k)
+            for (int j = 0; j <= p; ++j)
+              for (int i = 0; i+j <= p; ++i)
+                nodes[Impl::wedgeNodeIndex(p,i,j,k)] = {{i,j,k}};
+          break;
+        default:
+          DUNE_THROW(Dune::NotImplemented, "Lagrange cell type " << int(type) << " not supported.");
+      }
+      return nodes;
+    }
+
+
+    /// \brief Return the values of the linear shape functions of the corners of the VTK Lagrange
+    /// cell `type` of order `p` at the node `x`, multiplied by p^3
+    /**
+     * The values are integers and do not depend on the cell type if the node lies on a common
+     * edge or face of two cells, thus together with the corner indices they identify a node
+     * uniquely in a conforming grid. The cell types are those of \ref lagrangeNodes.
+     **/
+    inline std::vector<std::int64_t> lagrangeCornerWeights (std::uint8_t type, int p, LatticePoint const& x)
+    {
+      std::int64_t q = p, q2 = q*q;
+      std::int64_t x0 = x[0], x1 = x[1], x2 = x[2];
+      switch (type) {
+        case LAGRANGE_CURVE:
+          return {(q-x0)*q2, x0*q2};
+        case LAGRANGE_TRIANGLE:
+          return {(q-x0-x1)*q2, x0*q2, x1*q2};
+        case LAGRANGE_TETRAHEDRON:
+          return {(q-x0-x1-x2)*q2, x0*q2, x1*q2, x2*q2};
+        case LAGRANGE_QUADRILATERAL:
+          return {(q-x0)*(q-x1)*q, x0*(q-x1)*q, x0*x1*q, (q-x0)*x1*q};
+        case LAGRANGE_HEXAHEDRON:
+          return {(q-x0)*(q-x1)*(q-x2), x0*(q-x1)*(q-x2), x0*x1*(q-x2), (q-x0)*x1*(q-x2),
+                  (q-x0)*(q-x1)*x2,     x0*(q-x1)*x2,     x0*x1*x2,     (q-x0)*x1*x2};
+        case LAGRANGE_WEDGE:
+          return {(q-x0-x1)*(q-x2)*q, x0*(q-x2)*q, x1*(q-x2)*q,
+                  (q-x0-x1)*x2*q,     x0*x2*q,     x1*x2*q};
+        default:
+          DUNE_THROW(Dune::NotImplemented, "Lagrange cell type " << int(type) << " not supported.");
+      }
+    }
+
+  } // end namespace Vtk
+} // end namespace Dune
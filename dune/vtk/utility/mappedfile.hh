@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+  #define DUNE_VTK_HAVE_MMAP 1
+#endif
+
+namespace Dune
+{
+  namespace Vtk
+  {
+    /// A read-only memory mapping of a whole file
+    /**
+     * If memory mapping is not supported on the platform, or the file can not be
+     * mapped, \ref isOpen() returns false and the file must be read otherwise.
+     **/
+    class MappedFile
+    {
+    public:
+      /// Map the file `filename` into memory
+      explicit MappedFile (std::string const& filename)
+      {
+#if DUNE_VTK_HAVE_MMAP
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+          return;
+
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+          void* addr = ::mmap(nullptr, std::size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+          if (addr != MAP_FAILED) {
+            data_ = static_cast<unsigned char const*>(addr);
+            size_ = std::size_t(info.st_size);
+            ::madvise(addr, size_, MADV_SEQUENTIAL);
+          }
+        }
+        ::close(fd); // the mapping stays valid
+#endif
+      }
+
+      // disable copy and move operations
+      MappedFile (MappedFile const&) = delete;
+      MappedFile& operator= (MappedFile const&) = delete;
+
+      /// Remove the mapping
+      ~MappedFile ()
+      {
+#if DUNE_VTK_HAVE_MMAP
+        if (data_)
+          ::munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+      }
+
+      /// Return whether the file is mapped
+      bool isOpen () const
+      {
+        return data_ != nullptr;
+      }
+
+      /// Pointer to the first byte of the file
+      unsigned char const* data () const
+      {
+        return data_;
+      }
+
+      /// Size of the file in bytes
+      std::size_t size () const
+      {
+        return size_;
+      }
+
+      /// Hint that the bytes in [offset, offset+length) are read soon
+      void willNeed (std::size_t offset, std::size_t length) const
+      {
+#if DUNE_VTK_HAVE_MMAP
+        if (!data_ || offset >= size_)
+          return;
+
+        // madvise requires an address aligned to the page size
+        std::size_t page = std::size_t(::sysconf(_SC_PAGESIZE));
+        std::size_t first = offset - offset % page;
+        std::size_t last = offset + length < size_ ? offset + length : size_;
+        ::madvise(const_cast<unsigned char*>(data_ + first), last - first, MADV_WILLNEED);
+#endif
+      }
+
+    private:
+      unsigned char const* data_ = nullptr;
+      std::size_t size_ = 0;
+    };
+
+  } // end namespace Vtk
+} // end namespace Dune
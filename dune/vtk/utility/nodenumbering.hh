@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Dune
+{
+  namespace Vtk
+  {
+    /// Consecutive numbering of nodes placed on the vertices, edges, faces and in the interior of elements
+    /**
+     * A node is described by the integer weights of the corners of an element, e.g., the values
+     * of the linear shape functions at the node multiplied by a common scaling factor, given as
+     * pairs (local corner, weight) for the corners with nonzero weight only. Nodes on a vertex,
+     * edge, or face are identified by the grid indices of the corners of that subentity together
+     * with their weights, thus they get the same number in all elements containing them, as long
+     * as the grid is conforming. Nodes with nonzero weights for all corners of the element are
+     * interior nodes and are not shared.
+     **/
+    class NodeNumbering
+    {
+      // pairs (vertex index, weight), sorted by the vertex index
+      using Key = std::vector<std::pair<std::int64_t, std::int64_t>>;
+
+      struct KeyHash
+      {
+        std::size_t operator() (Key const& key) const
+        {
+          std::size_t seed = key.size();
+          for (auto const& k : key) {
+            seed ^= std::hash<std::int64_t>{}(k.first) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            seed ^= std::hash<std::int64_t>{}(k.second) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+          }
+          return seed;
+        }
+      };
+
+    public:
+      /// Remove all nodes and prepare the numbering for a grid with `numVertices` vertices
+      void reset (std::size_t numVertices)
+      {
+        vertexMap_.assign(numVertices, -1);
+        sharedNodes_.clear();
+        size_ = 0;
+      }
+
+      /// \brief Return the number of the node with corner `weights` in an element with `numCorners` corners
+      /**
+       * \param weights      Range of pairs (local corner, weight) with nonzero weight
+       * \param numCorners   Number of corners of the element
+       * \param vertexIndex  Callable mapping a local corner to the grid index of the vertex
+       **/
+      template <class Weights, class VertexIndex>
+      std::int64_t index (Weights const& weights, std::size_t numCorners, VertexIndex vertexIndex)
+      {
+        if (weights.size() == 1) {
+          // node on a vertex
+          std::int64_t& idx = vertexMap_[vertexIndex(weights.begin()->first)];
+          if (idx < 0)
+            idx = std::int64_t(size_++);
+          return idx;
+        }
+
+        if (weights.size() == numCorners) {
+          // node in the interior of the element
+          return std::int64_t(size_++);
+        }
+
+        // node on an edge or face
+        key_.clear();
+        for (auto const& w : weights)
+          key_.emplace_back(std::int64_t(vertexIndex(w.first)), std::int64_t(w.second));
+        std::sort(key_.begin(), key_.end());
+        auto it = sharedNodes_.find(key_);
+        if (it == sharedNodes_.end())
+          it = sharedNodes_.emplace(key_, std::int64_t(size_++)).first;
+        return it->second;
+      }
+
+      /// Return the number of nodes numbered so far
+      std::uint64_t size () const
+      {
+        return size_;
+      }
+
+    private:
+      std::vector<std::int64_t> vertexMap_;
+      std::unordered_map<Key, std::int64_t, KeyHash> sharedNodes_;
+      Key key_;
+      std::uint64_t size_ = 0;
+    };
+
+  } // end namespace Vtk
+} // end namespace Dune
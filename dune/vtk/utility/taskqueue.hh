@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <dune/vtk/utility/threadpool.hh>
+
+namespace Dune
+{
+  namespace Vtk
+  {
+    /// A background thread that processes tasks one after another in the order of submission
+    /**
+     * At most `maxPending` tasks are queued or running at the same time. Submitting
+     * a further task blocks until the oldest task is finished.
+     **/
+    class TaskQueue
+    {
+    public:
+      /// Start the background thread
+      explicit TaskQueue (std::size_t maxPending = 2)
+        : maxPending_(std::max<std::size_t>(maxPending, 1u))
+        , worker_([this] { this->run(); })
+      {}
+
+      // disable copy and move operations
+      TaskQueue (TaskQueue const&) = delete;
+      TaskQueue& operator= (TaskQueue const&) = delete;
+
+      /// Finish all queued tasks and join the background thread
+      ~TaskQueue ()
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          stop_ = true;
+        }
+        cv_.notify_all();
+        worker_.join();
+      }
+
+      /// Change the maximal number of pending tasks
+      void setMaxPending (std::size_t maxPending)
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          maxPending_ = std::max<std::size_t>(maxPending, 1u);
+        }
+        cv_.notify_all();
+      }
+
+      /// Enqueue the task `f` and return a future to its result. Blocks while the queue is full.
+      template <class F>
+      auto submit (F&& f) -> std::future<Impl::TaskResult_t<F>>
+      {
+        using R = Impl::TaskResult_t<F>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        auto future = task->get_future();
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          cv_.wait(lock, [this] { return pending_ < maxPending_; });
+          ++pending_;
+          tasks_.emplace([task] { (*task)(); });
+        }
+        cv_.notify_all();
+        return future;
+      }
+
+      /// Block until all submitted tasks are finished
+      void wait ()
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return pending_ == 0; });
+      }
+
+    private:
+      // Worker loop: take tasks from the queue until the queue is stopped
+      void run ()
+      {
+        while (true) {
+          std::function<void()> task;
+          {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            if (stop_ && tasks_.empty())
+              return;
+            task = std::move(tasks_.front());
+            tasks_.pop();
+          }
+          task();
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --pending_;
+          }
+          cv_.notify_all();
+        }
+      }
+
+    private:
+      std::size_t maxPending_;
+      std::size_t pending_ = 0;
+      std::queue<std::function<void()>> tasks_;
+
+      std::mutex mutex_;
+      std::condition_variable cv_;
+      bool stop_ = false;
+
+      std::thread worker_; // NOTE: started after all other members are initialized
+    };
+
+  } // end namespace Vtk
+} // end namespace Dune
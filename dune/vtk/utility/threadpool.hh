@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Dune
+{
+  namespace Vtk
+  {
+    namespace Impl
+    {
+      // The result type of a task `F` called without arguments
+#if __cpp_lib_is_invocable >= 201703L
+      template <class F>
+      using TaskResult_t = std::invoke_result_t<std::decay_t<F>>;
+#else
+      template <class F>
+      using TaskResult_t = std::result_of_t<std::decay_t<F>()>;
+#endif
+    } // end namespace Impl
+
+    /// A minimalistic pool of worker threads that process tasks from a common queue
+    /**
+     * With a pool size of 0 or 1 no threads are started and all tasks are executed
+     * directly in the calling thread.
+     **/
+    class ThreadPool
+    {
+    public:
+      /// Start `numThreads` worker threads
+      explicit ThreadPool (std::size_t numThreads = defaultNumThreads())
+      {
+        if (numThreads > 1) {
+          workers_.reserve(numThreads);
+          for (std::size_t i = 0; i < numThreads; ++i)
+            workers_.emplace_back([this] { this->run(); });
+        }
+      }
+
+      // disable copy and move operations
+      ThreadPool (ThreadPool const&) = delete;
+      ThreadPool& operator= (ThreadPool const&) = delete;
+
+      /// Finish all queued tasks and join the worker threads
+      ~ThreadPool ()
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& worker : workers_)
+          worker.join();
+      }
+
+      /// Number of tasks that can run concurrently
+      std::size_t size () const
+      {
+        return std::max<std::size_t>(workers_.size(), 1u);
+      }
+
+      /// Enqueue the task `f` and return a future to its result
+      // NOTE: Do not wait for the returned future inside a task of the same pool.
+      template <class F>
+      auto submit (F&& f) -> std::future<Impl::TaskResult_t<F>>
+      {
+        using R = Impl::TaskResult_t<F>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        auto future = task->get_future();
+
+        if (workers_.empty())
+          (*task)();
+        else {
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace([task] { (*task)(); });
+          }
+          cv_.notify_one();
+        }
+        return future;
+      }
+
+      /// Call `f(i)` for all i in [0,n) and distribute the calls over the pool.
+      /**
+       * The calling thread participates in the work and the function returns when
+       * all calls are finished. Thus, it is safe to call parallelFor from inside a
+       * task of the same pool. The first exception thrown by `f` is rethrown.
+       **/
+      template <class F>
+      void parallelFor (std::size_t n, F const& f)
+      {
+        if (workers_.empty() || n <= 1) {
+          for (std::size_t i = 0; i < n; ++i)
+            f(i);
+          return;
+        }
+
+        struct State
+        {
+          std::atomic<std::size_t> next{0};
+          std::size_t finished = 0;
+          std::exception_ptr error = nullptr;
+          std::mutex mutex;
+          std::condition_variable cv;
+        };
+
+        auto state = std::make_shared<State>();
+
+        // NOTE: a worker that starts after all indices are processed does not touch `f`.
+        auto work = [state,n,&f]
+        {
+          std::size_t done = 0;
+          for (std::size_t i; (i = state->next++) < n; ++done) {
+            try {
+              f(i);
+            } catch (...) {
+              std::lock_guard<std::mutex> lock(state->mutex);
+              if (!state->error)
+                state->error = std::current_exception();
+            }
+          }
+
+          if (done > 0) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->finished += done;
+            if (state->finished == n)
+              state->cv.notify_all();
+          }
+        };
+
+        std::size_t numHelpers = std::min(workers_.size(), n) - 1;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          for (std::size_t i = 0; i < numHelpers; ++i)
+            tasks_.emplace(work);
+        }
+        cv_.notify_all();
+
+        work();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->cv.wait(lock, [&state,n] { return state->finished == n; });
+        if (state->error)
+          std::rethrow_exception(state->error);
+      }
+
+      /// Number of hardware threads, at least 1
+      static std::size_t defaultNumThreads ()
+      {
+        return std::max(std::thread::hardware_concurrency(), 1u);
+      }
+
+      /// \brief A process-wide pool without worker threads, i.e., all tasks run in the calling thread
+      /**
+       * Several MPI ranks often share the cores of a node, so worker threads are started only
+       * on request, e.g., by a pool of \ref defaultNumThreads divided by the number of ranks
+       * per node.
+       **/
+      static ThreadPool& defaultPool ()
+      {
+        static ThreadPool pool{1};
+        return pool;
+      }
+
+    private:
+      // Worker loop: take tasks from the queue until the pool is stopped
+      void run ()
+      {
+        while (true) {
+          std::function<void()> task;
+          {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            if (stop_ && tasks_.empty())
+              return;
+            task = std::move(tasks_.front());
+            tasks_.pop();
+          }
+          task();
+        }
+      }
+
+    private:
+      std::vector<std::thread> workers_;
+      std::queue<std::function<void()>> tasks_;
+
+      std::mutex mutex_;
+      std::condition_variable cv_;
+      bool stop_ = false;
+    };
+
+  } // end namespace Vtk
+} // end namespace Dune
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <dune/vtk/utility/threadpool.hh>
+
+namespace Dune
+{
+  namespace Vtk
+  {
+    /// Result of \ref weldPoints
+    struct WeldedPoints
+    {
+      std::vector<std::size_t> index;   //< new index of each input point
+      std::vector<std::size_t> unique;  //< input index of each unique point, in increasing order
+    };
+
+    namespace Impl
+    {
+      // Spread the lower 21 bits of `x` such that two zero bits are between the bits
+      inline std::uint64_t spreadBits3 (std::uint64_t x)
+      {
+        x &= 0x1fffff;
+        x = (x | x << 32) & 0x1f00000000ffff;
+        x = (x | x << 16) & 0x1f0000ff0000ff;
+        x = (x | x << 8)  & 0x100f00f00f00f00f;
+        x = (x | x << 4)  & 0x10c30c30c30c30c3;
+        x = (x | x << 2)  & 0x1249249249249249;
+        return x;
+      }
+
+      // Morton key of the cell with integer coordinates `cell`
+      inline std::uint64_t mortonKey (std::int64_t const (&cell)[3])
+      {
+        return spreadBits3(std::uint64_t(cell[0]))
+            | (spreadBits3(std::uint64_t(cell[1])) << 1)
+            | (spreadBits3(std::uint64_t(cell[2])) << 2);
+      }
+
+      // Sort `values` by splitting into parts that are sorted in parallel and merged afterwards
+      template <class T>
+      void parallelSort (std::vector<T>& values, ThreadPool& pool)
+      {
+        std::size_t n = values.size();
+        std::size_t numParts = std::min(pool.size(), std::max<std::size_t>(n / 65536u, 1u));
+        std::vector<std::size_t> bounds(numParts+1);
+        for (std::size_t k = 0; k <= numParts; ++k)
+          bounds[k] = k*n/numParts;
+
+        pool.parallelFor(numParts, [&](std::size_t k) {
+          std::sort(values.begin() + bounds[k], values.begin() + bounds[k+1]);
+        });
+
+        // merge neighboring parts pairwise
+        for (std::size_t width = 1; width < numParts; width *= 2) {
+          std::size_t numMerges = (numParts + 2*width - 1) / (2*width);
+          pool.parallelFor(numMerges, [&](std::size_t m) {
+            std::size_t first = bounds[2*m*width];
+            std::size_t middle = bounds[std::min(2*m*width + width, numParts)];
+            std::size_t last = bounds[std::min(2*m*width + 2*width, numParts)];
+            std::inplace_merge(values.begin() + first, values.begin() + middle, values.begin() + last);
+          });
+        }
+      }
+
+    } // end namespace Impl
+
+
+    /// \brief Merge points that coincide up to the tolerance `tol` in each component
+    /**
+     * The points are sorted into a uniform grid of cells with edge length at least `tol`,
+     * ordered by the Morton key of the cells. Each point is then compared with the points
+     * in its cell and, if it is closer than `tol` to the cell boundary, in the neighboring
+     * cells. A point is mapped to the first point in the input order that coincides with
+     * it, or with a point that coincides with it. Sorting and searching run in parallel on
+     * the threads of `pool`.
+     *
+     * \tparam Point  A vector type with `size()` <= 3 and `operator[]`, e.g. `FieldVector`
+     **/
+    template <class Point>
+    WeldedPoints weldPoints (std::vector<Point> const& points, double tol,
+                             ThreadPool& pool = ThreadPool::defaultPool())
+    {
+      WeldedPoints result;
+      std::size_t n = points.size();
+      if (n == 0)
+        return result;
+
+      const int dow = int(points[0].size());
+      assert(dow <= 3);
+      const std::size_t blockSize = 4096;
+      const std::size_t numBlocks = (n + blockSize - 1) / blockSize;
+
+      // bounding box of all points
+      double lower[3] = {0.0, 0.0, 0.0}, upper[3] = {0.0, 0.0, 0.0};
+      for (int d = 0; d < dow; ++d)
+        lower[d] = upper[d] = double(points[0][d]);
+      for (auto const& p : points) {
+        for (int d = 0; d < dow; ++d) {
+          lower[d] = std::min(lower[d], double(p[d]));
+          upper[d] = std::max(upper[d], double(p[d]));
+        }
+      }
+
+      // cells are at least of size `tol` and there are at most 2^21 cells per direction
+      const std::int64_t maxCell = (1 << 21) - 1;
+      double h = tol;
+      for (int d = 0; d < dow; ++d)
+        h = std::max(h, (upper[d] - lower[d]) / double(maxCell));
+      if (!(h > 0.0))
+        h = 1.0;
+
+      auto cellOf = [&](Point const& p, std::int64_t (&cell)[3]) {
+        for (int d = 0; d < 3; ++d)
+          cell[d] = d < dow ? std::min(std::int64_t(std::floor((double(p[d]) - lower[d]) / h)), maxCell) : 0;
+      };
+
+      // sort the points by the Morton key of their cell
+      std::vector<std::pair<std::uint64_t, std::size_t>> sorted(n);
+      pool.parallelFor(numBlocks, [&](std::size_t b) {
+        for (std::size_t i = b*blockSize; i < std::min(n, (b+1)*blockSize); ++i) {
+          std::int64_t cell[3];
+          cellOf(points[i], cell);
+          sorted[i] = {Impl::mortonKey(cell), i};
+        }
+      });
+      Impl::parallelSort(sorted, pool);
+
+      auto coincide = [&](Point const& a, Point const& b) {
+        for (int d = 0; d < dow; ++d)
+          if (std::abs(double(a[d]) - double(b[d])) >= tol)
+            return false;
+        return true;
+      };
+
+      // first position of the cell of each sorted point
+      std::vector<std::size_t> runStart(n, 0);
+      for (std::size_t s = 1; s < n; ++s)
+        runStart[s] = sorted[s].first == sorted[s-1].first ? runStart[s-1] : s;
+
+      // smallest index of a coinciding point in the cell with key `key`, starting the search at `it`
+      auto searchCell = [&](Point const& p, std::uint64_t key, auto it, std::size_t j_min) {
+        for (; it != sorted.end() && it->first == key && it->second < j_min; ++it) {
+          if (coincide(p, points[it->second]))
+            j_min = it->second;
+        }
+        return j_min;
+      };
+
+      // find for each point the smallest index of a coinciding point
+      std::vector<std::size_t>& first = result.index;
+      first.resize(n);
+      pool.parallelFor(numBlocks, [&](std::size_t b) {
+        for (std::size_t s = b*blockSize; s < std::min(n, (b+1)*blockSize); ++s) {
+          std::size_t i = sorted[s].second;
+          Point const& p = points[i];
+          std::int64_t cell[3];
+          cellOf(p, cell);
+
+          // search the own cell first
+          std::size_t j_min = searchCell(p, sorted[s].first, sorted.begin() + runStart[s], i);
+
+          // range of neighboring cells that may contain coinciding points
+          std::int64_t lo[3] = {0,0,0}, hi[3] = {0,0,0};
+          for (int d = 0; d < dow; ++d) {
+            double x = double(p[d]) - lower[d];
+            lo[d] = (x - tol < double(cell[d])*h && cell[d] > 0) ? -1 : 0;
+            hi[d] = (x + tol >= double(cell[d]+1)*h && cell[d] < maxCell) ? 1 : 0;
+          }
+
+          std::int64_t c[3];
+          for (std::int64_t i0 = lo[0]; i0 <= hi[0]; ++i0) {
+            for (std::int64_t i1 = lo[1]; i1 <= hi[1]; ++i1) {
+              for (std::int64_t i2 = lo[2]; i2 <= hi[2]; ++i2) {
+                if (i0 == 0 && i1 == 0 && i2 == 0)
+                  continue;
+                c[0] = cell[0]+i0; c[1] = cell[1]+i1; c[2] = cell[2]+i2;
+                std::uint64_t key = Impl::mortonKey(c);
+                auto it = std::lower_bound(sorted.begin(), sorted.end(), std::make_pair(key, std::size_t(0)));
+                j_min = searchCell(p, key, it, j_min);
+              }
+            }
+          }
+          first[i] = j_min;
+        }
+      });
+
+      // resolve chains of coinciding points and number the unique points
+      std::vector<std::size_t> newIndex(n);
+      for (std::size_t i = 0; i < n; ++i) {
+        if (first[i] == i) {
+          newIndex[i] = result.unique.size();
+          result.unique.push_back(i);
+        } else {
+          first[i] = first[first[i]];
+        }
+      }
+      for (std::size_t i = 0; i < n; ++i)
+        first[i] = newIndex[first[i]];
+
+      return result;
+    }
+
+  } // end namespace Vtk
+} // end namespace Dune
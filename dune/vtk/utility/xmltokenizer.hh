@@ -0,0 +1,307 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Dune
+{
+  namespace Vtk
+  {
+    /// An XML tag with its attributes, filled by \ref XmlTokenizer
+    /**
+     * The attribute strings are reused when the tag is filled again, so that
+     * reading a sequence of tags does not allocate memory for each tag.
+     **/
+    class XmlTag
+    {
+    public:
+      std::string name;           //< name of the tag, without the leading '/' of closing tags
+      bool closing = false;       //< tag of the form </name>
+      bool selfClosing = false;   //< tag of the form <name .../>
+
+      /// Return the value of attribute `key`, or an empty string if it is not set
+      std::string const& attribute (char const* key) const
+      {
+        static const std::string empty{};
+        for (std::size_t i = 0; i < count_; ++i)
+          if (attributes_[i].first == key)
+            return attributes_[i].second;
+        return empty;
+      }
+
+      /// Return whether the attribute `key` is set
+      bool hasAttribute (char const* key) const
+      {
+        for (std::size_t i = 0; i < count_; ++i)
+          if (attributes_[i].first == key)
+            return true;
+        return false;
+      }
+
+      /// Remove name and attributes, but keep the allocated memory
+      void clear ()
+      {
+        name.clear();
+        closing = false;
+        selfClosing = false;
+        count_ = 0;
+      }
+
+      /// Remove all attributes, but keep the allocated memory
+      void clearAttributes ()
+      {
+        count_ = 0;
+      }
+
+      /// Append an empty attribute (name, value) and return a reference to it
+      std::pair<std::string,std::string>& addAttribute ()
+      {
+        if (count_ == attributes_.size())
+          attributes_.emplace_back();
+        auto& attr = attributes_[count_++];
+        attr.first.clear();
+        attr.second.clear();
+        return attr;
+      }
+
+    private:
+      std::vector<std::pair<std::string,std::string>> attributes_;
+      std::size_t count_ = 0;
+    };
+
+
+    /// A buffered tokenizer that reads the XML tags of a VTK file from an input stream
+    /**
+     * The tags may be distributed arbitrarily over the lines of the file. Comments,
+     * processing instructions and declarations are skipped. A self-closing tag
+     * `<name .../>` is returned as opening tag with `selfClosing = true`, followed
+     * by a closing tag `</name>`.
+     *
+     * The tokenizer reads the stream in blocks. Absolute positions in the stream are
+     * returned by \ref position(), e.g., to seek to the data of a DataArray later.
+     **/
+    class XmlTokenizer
+    {
+    public:
+      /// Read from `input`, starting at its current position, in blocks of `bufferSize` bytes
+      explicit XmlTokenizer (std::istream& input, std::size_t bufferSize = 1u << 16)
+        : input_(input)
+        , buffer_(std::max<std::size_t>(bufferSize, 16u))
+      {
+        std::streamoff start = input_.tellg();
+        base_ = start > 0 ? std::uint64_t(start) : 0u;
+      }
+
+      /// Read the next tag into `tag`. Returns false at the end of the input.
+      bool next (XmlTag& tag)
+      {
+        if (pendingClose_) {
+          pendingClose_ = false;
+          tag.closing = true;
+          tag.selfClosing = false;
+          tag.clearAttributes();
+          return true;
+        }
+
+        // find the next tag that is not a comment, declaration or processing instruction
+        for (;;) {
+          if (!skipTo('<'))
+            return false;
+          ++pos_;
+          int c = peek();
+          if (c == '?') {
+            if (!skipPast("?>"))
+              return false;
+          } else if (c == '!') {
+            if (!skipPast(startsWith("!--") ? "-->" : ">"))
+              return false;
+          } else {
+            break;
+          }
+        }
+
+        tag.clear();
+        if (peek() == '/') {
+          tag.closing = true;
+          ++pos_;
+        }
+        readName(tag.name);
+
+        for (;;) {
+          skipSpace();
+          int c = peek();
+          if (c == EOF) {
+            return false;
+          } else if (c == '>') {
+            ++pos_;
+            break;
+          } else if (c == '/') {
+            tag.selfClosing = true;
+            if (!skipPast(">"))
+              return false;
+            break;
+          }
+
+          auto& attr = tag.addAttribute();
+          readName(attr.first);
+          skipSpace();
+          if (peek() != '=')
+            continue; // attribute without value
+          ++pos_;
+          skipSpace();
+          int quote = peek();
+          if (quote != '"' && quote != '\'')
+            continue;
+          ++pos_;
+          if (!readUntil(char(quote), attr.second))
+            return false;
+          ++pos_;
+        }
+
+        pendingClose_ = tag.selfClosing;
+        return true;
+      }
+
+      /// Read the text up to the next tag into `text`
+      void readText (std::string& text)
+      {
+        text.clear();
+        readUntil('<', text);
+      }
+
+      /// Skip the text up to the next tag
+      void skipText ()
+      {
+        skipTo('<');
+      }
+
+      /// \brief Return the position of the first byte of the raw appended data
+      /**
+       * Must be called directly after the tag `<AppendedData>`. Skips whitespace and the
+       * leading `_` marker. Afterwards, no further tags can be read.
+       **/
+      std::uint64_t appendedDataPosition ()
+      {
+        skipSpace();
+        if (peek() == '_')
+          ++pos_;
+        return position();
+      }
+
+      /// Absolute position in the stream of the next character to read
+      std::uint64_t position () const
+      {
+        return base_ + pos_;
+      }
+
+    private:
+      // Make sure that at least one character is in the buffer. Returns false at the end of the input.
+      bool fill ()
+      {
+        if (pos_ < end_)
+          return true;
+
+        base_ += end_;
+        pos_ = 0;
+        input_.read(buffer_.data(), std::streamsize(buffer_.size()));
+        end_ = std::size_t(input_.gcount());
+        if (end_ < buffer_.size())
+          input_.clear(); // allow to seek in the stream after reaching its end
+        return end_ > 0;
+      }
+
+      int peek ()
+      {
+        return fill() ? int((unsigned char)buffer_[pos_]) : EOF;
+      }
+
+      static bool isSpace (int c)
+      {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\v';
+      }
+
+      void skipSpace ()
+      {
+        while (isSpace(peek()))
+          ++pos_;
+      }
+
+      // Move to the next occurrence of `c`. Returns false if not found.
+      bool skipTo (char c)
+      {
+        while (fill()) {
+          auto found = static_cast<char const*>(std::memchr(buffer_.data() + pos_, c, end_ - pos_));
+          if (found) {
+            pos_ = std::size_t(found - buffer_.data());
+            return true;
+          }
+          pos_ = end_;
+        }
+        return false;
+      }
+
+      // Append all characters up to the next occurrence of `c` to `out`. Returns false if not found.
+      bool readUntil (char c, std::string& out)
+      {
+        while (fill()) {
+          char const* first = buffer_.data() + pos_;
+          auto found = static_cast<char const*>(std::memchr(first, c, end_ - pos_));
+          if (found) {
+            out.append(first, std::size_t(found - first));
+            pos_ = std::size_t(found - buffer_.data());
+            return true;
+          }
+          out.append(first, end_ - pos_);
+          pos_ = end_;
+        }
+        return false;
+      }
+
+      // Move behind the next occurrence of the sequence `end`. Returns false if not found.
+      bool skipPast (char const* end)
+      {
+        std::size_t n = std::strlen(end);
+        std::string window;
+        while (fill()) {
+          window.push_back(buffer_[pos_++]);
+          if (window.size() > n)
+            window.erase(0, 1);
+          if (window == end)
+            return true;
+        }
+        return false;
+      }
+
+      // Test whether the next characters are `str`, if these are already in the buffer
+      bool startsWith (char const* str) const
+      {
+        std::size_t n = std::strlen(str);
+        return end_ - pos_ >= n && std::memcmp(buffer_.data() + pos_, str, n) == 0;
+      }
+
+      // Read a tag or attribute name
+      void readName (std::string& name)
+      {
+        for (int c = peek(); c != EOF && !isSpace(c) && c != '=' && c != '>' && c != '/'; c = peek()) {
+          name.push_back(char(c));
+          ++pos_;
+        }
+      }
+
+    private:
+      std::istream& input_;
+      std::vector<char> buffer_;
+      std::size_t pos_ = 0;     //< position of the next character in the buffer
+      std::size_t end_ = 0;     //< number of valid characters in the buffer
+      std::uint64_t base_ = 0;  //< position of the buffer in the stream
+      bool pendingClose_ = false;
+    };
+
+  } // end namespace Vtk
+} // end namespace Dune
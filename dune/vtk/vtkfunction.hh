@@ -1,10 +1,16 @@
 #pragma once
 
+#include <cassert>
+#include <memory>
 #include <type_traits>
+#include <vector>
 
 #include <dune/common/std/optional.hh>
 #include <dune/common/std/type_traits.hh>
+#include <dune/vtk/utility/derivedfield.hh>
+#include <dune/vtk/utility/indexedvalues.hh>
 
+#include "derivedvtkfunction.hh"
 #include "vtklocalfunction.hh"
 #include "vtktypes.hh"
 
@@ -45,6 +51,21 @@ namespace Dune
     template <class T>
     static constexpr int sizeOf () { return decltype(sizeOfImpl(std::declval<T>()))::value; }
 
+    // Discrete functions of scalar bases are evaluated by tables of shape function values
+    template <class F,
+      std::enable_if_t<Vtk::IsDiscreteScalarFunction<F,GridView>::value, int> = 0>
+    static VtkLocalFunction<GridView> makeLocalFunction (F&& fct)
+    {
+      return VtkLocalFunction<GridView>{std::make_shared<DiscreteLocalFunctionWrapper<GridView,std::decay_t<F>>>(fct)};
+    }
+
+    template <class F,
+      std::enable_if_t<!Vtk::IsDiscreteScalarFunction<F,GridView>::value, int> = 0>
+    static VtkLocalFunction<GridView> makeLocalFunction (F&& fct)
+    {
+      return localFunction(std::forward<F>(fct));
+    }
+
   public:
     /// Constructor VtkFunction from legacy VTKFunction
     /**
@@ -75,7 +96,7 @@ namespace Dune
     VtkFunction (F&& fct, std::string name,
                  Std::optional<int> ncomps = {},
                  Std::optional<Vtk::DataTypes> type = {})
-      : localFct_(localFunction(std::forward<F>(fct)))
+      : localFct_(makeLocalFunction(std::forward<F>(fct)))
       , name_(std::move(name))
     {
       using R = Range<decltype(localFunction(std::forward<F>(fct)))>;
@@ -91,6 +112,48 @@ namespace Dune
       : VtkFunction(std::forward<F>(fct), fieldInfo.name(), fieldInfo.ncomps(), type)
     {}
 
+    /// \brief Construct VtkFunction from values attached to the grid entities of codimension `values.codim()`
+    /**
+     * Data collectors copy the values directly where the points or cells coincide with the
+     * entities, otherwise the values are interpolated, see \ref IndexedLocalFunctionWrapper.
+     *
+     * \param gridView  The GridView whose index set numbers the values
+     * \param values    A view to the values, ordered by the entity index
+     * \param name      The name to use component identification in the VTK file
+     * \param ncomps    Number of components of the pointwise data. Is the block size of the
+     *                  values if not given.
+     * \param type      The \ref Vtk::DataTypes used in the output [Vtk::FLOAT32 for float
+     *                  values, Vtk::FLOAT64 otherwise]
+     **/
+    VtkFunction (GridView const& gridView, Vtk::IndexedValues const& values, std::string name,
+                 Std::optional<int> ncomps = {},
+                 Std::optional<Vtk::DataTypes> type = {})
+      : localFct_(gridView, values)
+      , name_(std::move(name))
+      , ncomps_(ncomps ? *ncomps : values.blockSize())
+      , type_(type ? *type : values.datatype() == Vtk::FLOAT32 ? Vtk::FLOAT32 : Vtk::FLOAT64)
+      , indexedValues_(values)
+    {}
+
+    /// \brief Construct VtkFunction computing the \ref Vtk::DerivedField `derived` from the `sources`
+    /**
+     * Writers compute the values from the arrays of the sources, if these are written in the
+     * same section of the file, otherwise the local functions of the sources are evaluated.
+     *
+     * \param derived  The operation and the names of the sources
+     * \param sources  The functions named in `derived.sources()`, in the same order
+     * \param name     The name to use component identification in the VTK file
+     * \param type     The \ref Vtk::DataTypes used in the output [type of the first source]
+     **/
+    VtkFunction (Vtk::DerivedField const& derived, std::vector<VtkFunction> const& sources,
+                 std::string name, Std::optional<Vtk::DataTypes> type = {})
+      : localFct_(makeDerivedLocalFunction(derived, sources))
+      , name_(std::move(name))
+      , ncomps_(derived.ncomps(sources.front().ncomps()))
+      , type_(type ? *type : sources.front().type())
+      , derived_(derived)
+    {}
+
     VtkFunction () = default;
 
     /// Create a LocalFunction
@@ -117,11 +180,44 @@ namespace Dune
       return type_;
     }
 
+    /// Return the values attached to grid entities, if the function is given by these, or nullptr
+    Vtk::IndexedValues const* indexedValues () const
+    {
+      return indexedValues_ ? &*indexedValues_ : nullptr;
+    }
+
+    /// Return the description of the derived field, if the function is computed from other
+    /// functions, or nullptr
+    Vtk::DerivedField const* derived () const
+    {
+      return derived_ ? &*derived_ : nullptr;
+    }
+
+  private:
+    // Wrap clones of the local functions of the `sources`, or copies that share the local
+    // functions, if these can not be cloned
+    static VtkLocalFunction<GridView> makeDerivedLocalFunction (Vtk::DerivedField const& derived,
+                                                                std::vector<VtkFunction> const& sources)
+    {
+      assert(sources.size() == derived.sources().size());
+      std::vector<VtkLocalFunction<GridView>> localFcts;
+      for (auto const& source : sources) {
+        assert(source.ncomps() == sources.front().ncomps());
+        auto localFct = localFunction(source);
+        localFcts.push_back(localFct.cloneable() ? localFct.clone() : localFct);
+      }
+
+      using Wrapper = DerivedLocalFunctionWrapper<GridView, VtkLocalFunction<GridView>>;
+      return VtkLocalFunction<GridView>{std::make_shared<Wrapper>(derived, std::move(localFcts), sources.front().ncomps())};
+    }
+
   private:
     VtkLocalFunction<GridView> localFct_;
     std::string name_;
     int ncomps_ = 1;
     Vtk::DataTypes type_ = Vtk::FLOAT32;
+    Std::optional<Vtk::IndexedValues> indexedValues_;
+    Std::optional<Vtk::DerivedField> derived_;
   };
 
 } // end namespace Dune
@@ -2,12 +2,16 @@
 
 #include <memory>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <dune/common/std/type_traits.hh>
 
 #include "vtklocalfunctioninterface.hh"
 #include "legacyvtkfunction.hh"
 #include "defaultvtkfunction.hh"
+#include "discretevtkfunction.hh"
+#include "indexedvtkfunction.hh"
 
 namespace Dune
 {
@@ -32,6 +36,15 @@ namespace Dune
       : localFct_(std::make_shared<VTKLocalFunctionWrapper<GridView>>(lf))
     {}
 
+    VtkLocalFunction (GridView const& gridView, Vtk::IndexedValues const& values)
+      : localFct_(std::make_shared<IndexedLocalFunctionWrapper<GridView>>(gridView, values))
+    {}
+
+    /// Store the already wrapped local function `lf`
+    VtkLocalFunction (std::shared_ptr<VtkLocalFunctionInterface<GridView>> lf)
+      : localFct_(std::move(lf))
+    {}
+
     VtkLocalFunction () = default;
 
     /// Bind the function to the grid entity
@@ -52,6 +65,34 @@ namespace Dune
       return localFct_->evaluate(comp, xi);
     }
 
+    /// \brief Evaluate the components [0,ncomps) at all the local coordinates `xi`
+    /**
+     * Stores the values in `values[i*ncomps + comp]`, which must provide space for
+     * xi.size()*ncomps values. The function is evaluated only once per coordinate.
+     **/
+    void evaluateAll (std::vector<LocalCoordinate> const& xi, int ncomps, double* values) const
+    {
+      localFct_->evaluateAll(xi.data(), xi.size(), ncomps, values);
+    }
+
+    /// Return whether the wrapped function can be cloned, see \ref clone
+    bool cloneable () const
+    {
+      return localFct_->cloneable();
+    }
+
+    /// \brief Return an independent copy of the local function
+    /**
+     * Copies of a VtkLocalFunction share the wrapped function. A clone can be bound to
+     * other entities than this function, e.g., in another thread. Requires \ref cloneable.
+     **/
+    VtkLocalFunction clone () const
+    {
+      VtkLocalFunction copy;
+      copy.localFct_ = localFct_->clone();
+      return copy;
+    }
+
   private:
     std::shared_ptr<VtkLocalFunctionInterface<GridView>> localFct_;
   };
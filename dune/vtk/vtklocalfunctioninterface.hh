@@ -1,5 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
+
+#include <dune/common/exceptions.hh>
+
 namespace Dune
 {
   /// An abstract base class for LocalFunctions
@@ -19,6 +24,40 @@ namespace Dune
     /// Evaluate single component comp in the entity at local coordinates xi
     virtual double evaluate (int comp, LocalCoordinate const& xi) const = 0;
 
+    /// \brief Evaluate the components [0,ncomps) at the `n` local coordinates `xi`
+    /**
+     * The values are stored in `values[i*ncomps + comp]`, thus `values` must provide space
+     * for n*ncomps values. The default implementation calls \ref evaluate for each component.
+     * Implementations should override it to evaluate the function only once per point.
+     **/
+    virtual void evaluateAll (LocalCoordinate const* xi, std::size_t n, int ncomps, double* values) const
+    {
+      for (std::size_t i = 0; i < n; ++i)
+        for (int comp = 0; comp < ncomps; ++comp)
+          values[i*ncomps + comp] = evaluate(comp, xi[i]);
+    }
+
+    /// \brief Return whether \ref clone is implemented
+    /**
+     * The default implementation returns false. Local functions that can not be cloned are
+     * shared by all users, thus the data collectors evaluate them without threads, see
+     * \ref DataCollectorInterface::setThreadPool.
+     **/
+    virtual bool cloneable () const
+    {
+      return false;
+    }
+
+    /// \brief Return an independent copy that can be bound and evaluated concurrently to this function
+    /**
+     * Must be implemented if \ref cloneable returns true. The default implementation throws
+     * a NotImplemented exception.
+     **/
+    virtual std::unique_ptr<VtkLocalFunctionInterface> clone () const
+    {
+      DUNE_THROW(Dune::NotImplemented, "The local function can not be cloned.");
+    }
+
     /// Virtual destructor
     virtual ~VtkLocalFunctionInterface () = default;
   };
@@ -2,10 +2,17 @@
 
 #include <iosfwd>
 #include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <dune/vtk/filereader.hh>
 #include <dune/vtk/forward.hh>
 #include <dune/vtk/vtktypes.hh>
+#include <dune/vtk/utility/mappedfile.hh>
+#include <dune/vtk/utility/string.hh>
+#include <dune/vtk/utility/threadpool.hh>
+#include <dune/vtk/utility/xmltokenizer.hh>
 
 // default GridCreator
 #include <dune/vtk/gridcreators/continuousgridcreator.hh>
@@ -17,7 +24,7 @@ namespace Dune
    * Reads .vtu files and constructs a grid from the cells stored in the file
    * Additionally, stored data can be read.
    *
-   * Assumption on the file structure: Each XML tag must be on a separate line.
+   * The XML tags may be distributed arbitrarily over the lines of the file.
    **/
   template <class Grid, class GridCreator>
   class VtkReader
@@ -26,14 +33,27 @@ namespace Dune
     // Sections visited during the xml parsing
     enum Sections {
       NO_SECTION = 0, VTK_FILE, UNSTRUCTURED_GRID, PIECE, POINT_DATA, PD_DATA_ARRAY, CELL_DATA, CD_DATA_ARRAY,
-      POINTS, POINTS_DATA_ARRAY, CELLS, CELLS_DATA_ARRAY, APPENDED_DATA, XML_NAME, XML_NAME_ASSIGN, XML_VALUE
+      POINTS, POINTS_DATA_ARRAY, CELLS, CELLS_DATA_ARRAY, APPENDED_DATA
     };
 
     struct DataArrayAttributes
     {
       Vtk::DataTypes type;
       std::size_t components = 1;
-      std::uint64_t offset = 0;
+      std::uint64_t offset = 0;   //< offset in the appended section, or position of ASCII data in the file
+      Vtk::FormatTypes format = Vtk::ASCII;
+    };
+
+    // Compressed blocks of a DataArray read from the appended section, to be
+    // uncompressed into the memory pointed to by `values`.
+    struct CompressedBlocks
+    {
+      unsigned char* values = nullptr;
+      std::uint64_t block_size = 0;
+      std::uint64_t last_block_size = 0;
+      std::vector<std::uint64_t> positions; //< begin of the blocks in `data` (+ end of last block)
+      std::vector<unsigned char> data;      //< the compressed data
+      unsigned char const* source = nullptr; //< the compressed data in the mapped file, used instead of `data`
     };
 
     using Entity = typename Grid::template Codim<0>::Entity;
@@ -101,54 +121,162 @@ namespace Dune
       return pieces_;
     }
 
-  private:
-    // Read values stored on the cells with name `name`
+    /// \brief Set the number of threads used to uncompress the appended data blocks
+    /**
+     * By default, the data is uncompressed in the calling thread. If several MPI ranks
+     * share one node, the number of threads should be chosen such that the ranks together
+     * do not use more threads than cores. A value of 1 disables the multi-threaded decoding.
+     **/
+    VtkReader& setNumThreads (std::size_t numThreads)
+    {
+      threadPool_ = std::make_shared<Vtk::ThreadPool>(numThreads);
+      return *this;
+    }
+
+    /// \brief Enable or disable reading the appended data from a memory mapping of the file
+    /**
+     * If enabled [default], \ref readFromFile maps the file into memory and reads the
+     * raw and compressed appended arrays directly from the mapping, instead of reading
+     * them through the stream. If the file can not be mapped, the stream is used.
+     **/
+    VtkReader& setMemoryMapping (bool enabled = true)
+    {
+      memoryMapping_ = enabled;
+      return *this;
+    }
+
+    /// \brief Read the point data with name `name` from the file into `values`
+    /**
+     * The DataArray is decoded only on request and its values are converted to `T`.
+     * The vector `values` is resized to `NumberOfPoints*NumberOfComponents`, so that a
+     * buffer of the caller can be reused for several fields. Requires that the grid
+     * was read by \ref readFromFile from a .vtu file.
+     **/
     template <class T>
-    Sections readCellData (std::ifstream& /*input*/, std::vector<T>& /*values*/, std::string /*name*/)
+    void pointData (std::string const& name, std::vector<T>& values)
     {
-      /* does not read anything */
-      return CD_DATA_ARRAY;
+      readFieldData(findField(pointDataArrays_, name), numberOfPoints_, values);
     }
 
+    /// Return the point data with name `name`, see \ref pointData(std::string const&, std::vector<T>&)
     template <class T>
-    Sections readPointData (std::ifstream& /*input*/, std::vector<T>& /*values*/, std::string /*name*/)
+    std::vector<T> pointData (std::string const& name)
+    {
+      std::vector<T> values;
+      pointData(name, values);
+      return values;
+    }
+
+    /// \brief Read the cell data with name `name` from the file into `values`
+    /**
+     * The vector `values` is resized to `NumberOfCells*NumberOfComponents`. See
+     * \ref pointData(std::string const&, std::vector<T>&) for details.
+     **/
+    template <class T>
+    void cellData (std::string const& name, std::vector<T>& values)
+    {
+      readFieldData(findField(cellDataArrays_, name), numberOfCells_, values);
+    }
+
+    /// Return the cell data with name `name`, see \ref cellData(std::string const&, std::vector<T>&)
+    template <class T>
+    std::vector<T> cellData (std::string const& name)
+    {
+      std::vector<T> values;
+      cellData(name, values);
+      return values;
+    }
+
+    /// Return the (lowercase) names of all point data arrays stored in the file
+    std::vector<std::string> pointDataNames () const
+    {
+      return fieldNames(pointDataArrays_);
+    }
+
+    /// Return the (lowercase) names of all cell data arrays stored in the file
+    std::vector<std::string> cellDataNames () const
+    {
+      return fieldNames(cellDataArrays_);
+    }
+
+  private:
+    // Return the attributes of the DataArray with name `name` in `fields`
+    DataArrayAttributes const& findField (std::map<std::string, DataArrayAttributes> const& fields,
+                                          std::string const& name) const
     {
-      /* does not read anything */
-      return PD_DATA_ARRAY;
+      auto it = fields.find(to_lower(name));
+      if (it == fields.end())
+        DUNE_THROW(IOError, "No DataArray with name '" << name << "' found.");
+      return it->second;
     }
 
-    // Read vertex coordinates from `input` stream and store in into `factory`
-    Sections readPoints (std::ifstream& input, std::string name);
+    static std::vector<std::string> fieldNames (std::map<std::string, DataArrayAttributes> const& fields)
+    {
+      std::vector<std::string> names;
+      for (auto const& field : fields)
+        names.push_back(field.first);
+      return names;
+    }
 
+    // Read the values of the point or cell data array `data` from the file and convert to `T`.
+    // Throws an IOError if the array does not have `numEntities*data.components` values.
     template <class T>
-    void readPointsAppended (std::ifstream& input);
+    void readFieldData (DataArrayAttributes const& data, std::size_t numEntities, std::vector<T>& values);
 
-    // Read cell type, cell offsets and connectivity from `input` stream
-    Sections readCells (std::ifstream& input, std::string name);
+    // Read the values of the DataArray `data` stored with type `S` and convert to `T`
+    template <class S, class T>
+    void readFieldData (std::ifstream& input, DataArrayAttributes const& data, std::vector<T>& values);
 
-    void readCellsAppended (std::ifstream& input);
+    // Read vertex coordinates from the ASCII `text` of a DataArray
+    void readPoints (std::string const& text, std::string name);
 
-    // Read data from appended section in vtk file, starting from `offset`
+    // Read points, cells and point ids from the appended section and uncompress
+    // all blocks of all these DataArrays in parallel.
     template <class T>
-    void readAppended (std::ifstream& input, std::vector<T>& values, std::uint64_t offset);
+    void readGridAppended (std::ifstream& input);
 
-    // Test whether line belongs to section
-    bool isSection (std::string line,
-                    std::string key,
+    // Read cell type, cell offsets and connectivity from the ASCII `text` of a DataArray
+    void readCells (std::string const& text, std::string name);
+
+    // Read cell type, cell offsets, connectivity and point ids from the appended section.
+    // Compressed data is collected in `compressed` but not yet uncompressed.
+    void readCellsAppended (std::ifstream& input, std::vector<CompressedBlocks>& compressed);
+
+    // Read the DataArray `data` from appended section in vtk file, starting from `data.offset`
+    template <class T>
+    void readAppended (std::ifstream& input, std::vector<T>& values, DataArrayAttributes const& data);
+
+    // Read the DataArray `data` from appended section in vtk file, starting from `data.offset`.
+    // The `values` are resized to the stored size. Compressed data is appended to `compressed`
+    // and must be uncompressed with \ref uncompressAppended, before `values` is accessed.
+    template <class T>
+    void readAppended (std::ifstream& input, std::vector<T>& values, DataArrayAttributes const& data,
+                       std::vector<CompressedBlocks>& compressed);
+
+    // Uncompress all blocks of all DataArrays in `compressed` in parallel.
+    void uncompressAppended (std::vector<CompressedBlocks> const& compressed) const;
+
+    // Test whether tag opens (or closes, if key starts with '/') the section `key`
+    bool isSection (Vtk::XmlTag const& tag,
+                    std::string const& key,
                     Sections current,
                     Sections parent = NO_SECTION) const
     {
-      bool result = line.substr(1, key.length()) == key;
+      bool closing = (key[0] == '/');
+      bool result = tag.closing == closing && key.compare(closing ? 1 : 0, std::string::npos, tag.name) == 0;
       if (result && current != parent)
         DUNE_THROW(Exception , "<" << key << "> in wrong section." );
       return result;
     }
 
-    // Find beginning of appended binary data
-    std::uint64_t findAppendedDataPosition (std::ifstream& input) const;
-
-    // Read attributes from current xml tag
-    std::map<std::string, std::string> parseXml(std::string const& line, bool& closed);
+    // Return a pointer to the `size` bytes at position `pos` in the mapped file
+    unsigned char const* mappedBytes (std::uint64_t pos, std::uint64_t size) const
+    {
+      assert(mappedFile_);
+      if (pos + size > mappedFile_->size())
+        DUNE_THROW(IOError, "Appended data exceeds the size of the file.");
+      return mappedFile_->data() + pos;
+    }
 
     // clear all vectors
     void clear ();
@@ -158,6 +286,12 @@ namespace Dune
       return MPIHelper::getCollectiveCommunication();
     }
 
+    // Returns the thread pool used for decompression
+    Vtk::ThreadPool& threadPool () const
+    {
+      return threadPool_ ? *threadPool_ : Vtk::ThreadPool::defaultPool();
+    }
+
   private:
     std::unique_ptr<GridCreator> creatorStorage_ = nullptr;
     GridCreator& creator_;
@@ -176,14 +310,26 @@ namespace Dune
     std::size_t numberOfPoints_ = 0;  //< Number of vertices in the grid
 
     // offset information for appended data
-    // map Name -> {DataType,NumberOfComponents,Offset}
+    // map Name -> {DataType,NumberOfComponents,Offset,Format}
     std::map<std::string, DataArrayAttributes> dataArray_;
+    std::map<std::string, DataArrayAttributes> pointDataArrays_;
+    std::map<std::string, DataArrayAttributes> cellDataArrays_;
+
+    // name of the file read by \ref readFromFile, used to read the data arrays on request
+    std::string filename_;
 
     // vector of filenames of parallel pieces
     std::vector<std::string> pieces_;
 
     /// Offset of beginning of appended data
     std::uint64_t offset0_ = 0;
+
+    // thread pool to uncompress blocks in parallel. If not set, the default pool is used.
+    std::shared_ptr<Vtk::ThreadPool> threadPool_ = nullptr;
+
+    // memory mapping of the file read in \ref readFromFile, if enabled and supported
+    bool memoryMapping_ = true;
+    std::unique_ptr<Vtk::MappedFile> mappedFile_ = nullptr;
   };
 
 } // end namespace Dune
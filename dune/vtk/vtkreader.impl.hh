@@ -1,6 +1,9 @@
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <fstream>
 #include <iterator>
+#include <numeric>
 #include <string>
 
 #if HAVE_VTK_ZLIB
@@ -10,6 +13,7 @@
 #include <dune/common/classname.hh>
 #include <dune/common/version.hh>
 
+#include "utility/charconv.hh"
 #include "utility/filesystem.hh"
 #include "utility/string.hh"
 
@@ -27,8 +31,16 @@ void VtkReader<Grid,Creator>::readFromFile (std::string const& filename, bool cr
 
   std::string ext = filesystem::path(filename).extension().string();
   if (ext == ".vtu") {
+    mappedFile_.reset();
+    if (memoryMapping_) {
+      mappedFile_ = std::make_unique<Vtk::MappedFile>(filename);
+      if (!mappedFile_->isOpen())
+        mappedFile_.reset();
+    }
     readSerialFileFromStream(input, create);
+    mappedFile_.reset();
     pieces_.push_back(filename);
+    filename_ = filename;
   } else if (ext == ".pvtu") {
     readParallelFileFromStream(input, comm().rank(), comm().size(), create);
   } else {
@@ -47,78 +59,71 @@ void VtkReader<Grid,Creator>::readSerialFileFromStream (std::ifstream& input, bo
   std::size_t data_components = 0;
   std::uint64_t data_offset = 0;
 
+  Vtk::XmlTokenizer tokenizer(input);
+  Vtk::XmlTag tag;
+  std::string text;
+
   Sections section = NO_SECTION;
-  for (std::string line; std::getline(input, line); ) {
-    ltrim(line);
-
-    if (isSection(line, "VTKFile", section)) {
-      bool closed = false;
-      auto attr = parseXml(line, closed);
-
-      if (!attr["type"].empty())
-        assert(attr["type"] == "UnstructuredGrid");
-      if (!attr["version"].empty())
-        assert(std::stod(attr["version"]) == 1.0);
-      if (!attr["byte_order"].empty())
-        assert(attr["byte_order"] == "LittleEndian");
-      if (!attr["header_type"].empty())
-        assert(attr["header_type"] == "UInt64");
-      if (!attr["compressor"].empty()) {
-        compressor = attr["compressor"];
+  while (tokenizer.next(tag)) {
+    if (isSection(tag, "VTKFile", section)) {
+      if (!tag.attribute("type").empty())
+        assert(tag.attribute("type") == "UnstructuredGrid");
+      if (!tag.attribute("version").empty())
+        assert(std::stod(tag.attribute("version")) == 1.0);
+      if (!tag.attribute("byte_order").empty())
+        assert(tag.attribute("byte_order") == "LittleEndian");
+      if (!tag.attribute("header_type").empty())
+        assert(tag.attribute("header_type") == "UInt64");
+      if (!tag.attribute("compressor").empty()) {
+        compressor = tag.attribute("compressor");
         assert(compressor == "vtkZLibDataCompressor"); // only ZLib compression supported
       }
       section = VTK_FILE;
     }
-    else if (isSection(line, "/VTKFile", section, VTK_FILE))
+    else if (isSection(tag, "/VTKFile", section, VTK_FILE))
       section = NO_SECTION;
-    else if (isSection(line, "UnstructuredGrid", section, VTK_FILE))
+    else if (isSection(tag, "UnstructuredGrid", section, VTK_FILE))
       section = UNSTRUCTURED_GRID;
-    else if (isSection(line, "/UnstructuredGrid", section, UNSTRUCTURED_GRID))
+    else if (isSection(tag, "/UnstructuredGrid", section, UNSTRUCTURED_GRID))
       section = VTK_FILE;
-    else if (isSection(line, "Piece", section, UNSTRUCTURED_GRID)) {
-      bool closed = false;
-      auto attr = parseXml(line, closed);
-
-      assert(attr.count("NumberOfPoints") > 0 && attr.count("NumberOfCells") > 0);
-      numberOfPoints_ = std::stoul(attr["NumberOfPoints"]);
-      numberOfCells_ = std::stoul(attr["NumberOfCells"]);
+    else if (isSection(tag, "Piece", section, UNSTRUCTURED_GRID)) {
+      assert(tag.hasAttribute("NumberOfPoints") && tag.hasAttribute("NumberOfCells"));
+      numberOfPoints_ = std::stoul(tag.attribute("NumberOfPoints"));
+      numberOfCells_ = std::stoul(tag.attribute("NumberOfCells"));
       section = PIECE;
     }
-    else if (isSection(line, "/Piece", section, PIECE))
+    else if (isSection(tag, "/Piece", section, PIECE))
       section = UNSTRUCTURED_GRID;
-    else if (isSection(line, "PointData", section, PIECE))
+    else if (isSection(tag, "PointData", section, PIECE))
       section = POINT_DATA;
-    else if (isSection(line, "/PointData", section, POINT_DATA))
+    else if (isSection(tag, "/PointData", section, POINT_DATA))
       section = PIECE;
-    else if (isSection(line, "CellData", section, PIECE))
+    else if (isSection(tag, "CellData", section, PIECE))
       section = CELL_DATA;
-    else if (isSection(line, "/CellData", section, CELL_DATA))
+    else if (isSection(tag, "/CellData", section, CELL_DATA))
       section = PIECE;
-    else if (isSection(line, "Points", section, PIECE))
+    else if (isSection(tag, "Points", section, PIECE))
       section = POINTS;
-    else if (isSection(line, "/Points", section, POINTS))
+    else if (isSection(tag, "/Points", section, POINTS))
       section = PIECE;
-    else if (isSection(line, "Cells", section, PIECE))
+    else if (isSection(tag, "Cells", section, PIECE))
       section = CELLS;
-    else if (isSection(line, "/Cells", section, CELLS))
+    else if (isSection(tag, "/Cells", section, CELLS))
       section = PIECE;
-    else if (line.substr(1,9) == "DataArray") {
-      bool closed = false;
-      auto attr = parseXml(line, closed);
-
-      data_type = Vtk::Map::to_datatype[attr["type"]];
+    else if (!tag.closing && tag.name == "DataArray") {
+      data_type = Vtk::Map::to_datatype[tag.attribute("type")];
 
-      if (!attr["Name"].empty())
-        data_name = to_lower(attr["Name"]);
+      if (!tag.attribute("Name").empty())
+        data_name = to_lower(tag.attribute("Name"));
       else if (section == POINTS)
         data_name = "points";
 
       data_components = 1;
-      if (!attr["NumberOfComponents"].empty())
-        data_components = std::stoul(attr["NumberOfComponents"]);
+      if (!tag.attribute("NumberOfComponents").empty())
+        data_components = std::stoul(tag.attribute("NumberOfComponents"));
 
       // determine FormatType
-      data_format = to_lower(attr["format"]);
+      data_format = to_lower(tag.attribute("format"));
       if (data_format == "appended") {
         format_ = !compressor.empty() ? Vtk::COMPRESSED : Vtk::BINARY;
       } else {
@@ -127,25 +132,21 @@ void VtkReader<Grid,Creator>::readSerialFileFromStream (std::ifstream& input, bo
 
       // Offset makes sense in appended mode only
       data_offset = 0;
-      if (!attr["offset"].empty()) {
-        data_offset = std::stoul(attr["offset"]);
+      if (!tag.attribute("offset").empty()) {
+        data_offset = std::stoul(tag.attribute("offset"));
         assert(data_format == "appended");
       }
 
-      // Store attributes of DataArray
-      dataArray_[data_name] = {data_type, data_components, data_offset};
-
-      // Skip section in appended mode
-      if (data_format == "appended") {
-        if (!closed) {
-          while (std::getline(input, line)) {
-            ltrim(line);
-            if (line.substr(1,10) == "/DataArray")
-              break;
-          }
-        }
-        continue;
-      }
+      // Store attributes of DataArray. For ASCII data, the position of the values in the file is stored.
+      if (format_ == Vtk::ASCII)
+        data_offset = tokenizer.position();
+      DataArrayAttributes attributes{data_type, data_components, data_offset, format_};
+      if (section == POINT_DATA)
+        pointDataArrays_[data_name] = attributes;
+      else if (section == CELL_DATA)
+        cellDataArrays_[data_name] = attributes;
+      else
+        dataArray_[data_name] = attributes;
 
       if (section == POINT_DATA)
         section = PD_DATA_ARRAY;
@@ -157,8 +158,31 @@ void VtkReader<Grid,Creator>::readSerialFileFromStream (std::ifstream& input, bo
         section = CELLS_DATA_ARRAY;
       else
         DUNE_THROW(Exception, "Wrong section for <DataArray>");
+
+      // Appended data is read in the AppendedData section
+      if (data_format == "appended" || tag.selfClosing)
+        continue;
+
+      switch (section) {
+        case PD_DATA_ARRAY:
+        case CD_DATA_ARRAY:
+          // point and cell data is read on request, see pointData() and cellData()
+          tokenizer.skipText();
+          break;
+        case POINTS_DATA_ARRAY:
+          tokenizer.readText(text);
+          readPoints(text, data_name);
+          break;
+        case CELLS_DATA_ARRAY:
+          tokenizer.readText(text);
+          readCells(text, data_name);
+          break;
+        default:
+          // do nothing
+          break;
+      }
     }
-    else if (line.substr(1,10) == "/DataArray") {
+    else if (tag.closing && tag.name == "DataArray") {
       if (section == PD_DATA_ARRAY)
         section = POINT_DATA;
       else if (section == POINTS_DATA_ARRAY)
@@ -170,53 +194,18 @@ void VtkReader<Grid,Creator>::readSerialFileFromStream (std::ifstream& input, bo
       else
         DUNE_THROW(Exception, "Wrong section for </DataArray>");
     }
-    else if (isSection(line, "AppendedData", section, VTK_FILE)) {
-      bool closed = false;
-      auto attr = parseXml(line, closed);
-      if (!attr["encoding"].empty())
-        assert(attr["encoding"] == "raw"); // base64 encoding not supported
+    else if (isSection(tag, "AppendedData", section, VTK_FILE)) {
+      if (!tag.attribute("encoding").empty())
+        assert(tag.attribute("encoding") == "raw"); // base64 encoding not supported
 
-      offset0_ = findAppendedDataPosition(input);
+      offset0_ = tokenizer.appendedDataPosition();
       if (dataArray_["points"].type == Vtk::FLOAT32)
-        readPointsAppended<float>(input);
+        readGridAppended<float>(input);
       else
-        readPointsAppended<double>(input);
+        readGridAppended<double>(input);
 
-      readCellsAppended(input);
       section = NO_SECTION; // finish reading after appended section
     }
-    else if (isSection(line, "/AppendedData", section, APPENDED_DATA))
-      section = VTK_FILE;
-
-    switch (section) {
-      case PD_DATA_ARRAY:
-        if (data_type == Vtk::FLOAT32) {
-          std::vector<float> values;
-          section = readPointData(input, values, data_name);
-        } else if (data_type == Vtk::FLOAT64) {
-          std::vector<double> values;
-          section = readPointData(input, values, data_name);
-        }
-        break;
-      case POINTS_DATA_ARRAY:
-        section = readPoints(input, data_name);
-        break;
-      case CD_DATA_ARRAY:
-        if (data_type == Vtk::FLOAT32) {
-          std::vector<float> values;
-          section = readCellData(input, values, data_name);
-        } else if (data_type == Vtk::FLOAT64) {
-          std::vector<double> values;
-          section = readCellData(input, values, data_name);
-        }
-        break;
-      case CELLS_DATA_ARRAY:
-        section = readCells(input, data_name);
-        break;
-      default:
-        // do nothing
-        break;
-    }
 
     if (section == NO_SECTION)
       break;
@@ -235,38 +224,33 @@ void VtkReader<Grid,Creator>::readParallelFileFromStream (std::ifstream& input,
 {
   clear();
 
+  Vtk::XmlTokenizer tokenizer(input);
+  Vtk::XmlTag tag;
+
   Sections section = NO_SECTION;
-  for (std::string line; std::getline(input, line); ) {
-    ltrim(line);
-
-    if (isSection(line, "VTKFile", section)) {
-      bool closed = false;
-      auto attr = parseXml(line, closed);
-
-      if (!attr["type"].empty())
-        assert(attr["type"] == "PUnstructuredGrid");
-      if (!attr["version"].empty())
-        assert(std::stod(attr["version"]) == 1.0);
-      if (!attr["byte_order"].empty())
-        assert(attr["byte_order"] == "LittleEndian");
-      if (!attr["header_type"].empty())
-        assert(attr["header_type"] == "UInt64");
-      if (!attr["compressor"].empty())
-        assert(attr["compressor"] == "vtkZLibDataCompressor"); // only ZLib compression supported
+  while (tokenizer.next(tag)) {
+    if (isSection(tag, "VTKFile", section)) {
+      if (!tag.attribute("type").empty())
+        assert(tag.attribute("type") == "PUnstructuredGrid");
+      if (!tag.attribute("version").empty())
+        assert(std::stod(tag.attribute("version")) == 1.0);
+      if (!tag.attribute("byte_order").empty())
+        assert(tag.attribute("byte_order") == "LittleEndian");
+      if (!tag.attribute("header_type").empty())
+        assert(tag.attribute("header_type") == "UInt64");
+      if (!tag.attribute("compressor").empty())
+        assert(tag.attribute("compressor") == "vtkZLibDataCompressor"); // only ZLib compression supported
       section = VTK_FILE;
     }
-    else if (isSection(line, "/VTKFile", section, VTK_FILE))
+    else if (isSection(tag, "/VTKFile", section, VTK_FILE))
       section = NO_SECTION;
-    else if (isSection(line, "PUnstructuredGrid", section, VTK_FILE))
+    else if (isSection(tag, "PUnstructuredGrid", section, VTK_FILE))
       section = UNSTRUCTURED_GRID;
-    else if (isSection(line, "/PUnstructuredGrid", section, UNSTRUCTURED_GRID))
+    else if (isSection(tag, "/PUnstructuredGrid", section, UNSTRUCTURED_GRID))
       section = VTK_FILE;
-    else if (isSection(line, "Piece", section, UNSTRUCTURED_GRID)) {
-      bool closed = false;
-      auto attr = parseXml(line, closed);
-
-      assert(attr.count("Source") > 0);
-      pieces_.push_back(attr["Source"]);
+    else if (isSection(tag, "Piece", section, UNSTRUCTURED_GRID)) {
+      assert(tag.hasAttribute("Source"));
+      pieces_.push_back(tag.attribute("Source"));
     }
 
     if (section == NO_SECTION)
@@ -283,48 +267,65 @@ void VtkReader<Grid,Creator>::readParallelFileFromStream (std::ifstream& input,
 
 // @{ implementation detail
 /**
- * Read ASCII data from `input` stream into vector `values`
- * \param max_size  Upper bound for the number of values
- * \param section   Current XML section you are reading in
- * \param parent_section   XML Section to return when current `section` is finished.
+ * Parse the whitespace separated values in `text` and append these to `values`. Large
+ * texts are split at whitespace into parts that are parsed in parallel on the `pool`.
+ * Throws an IOError at the first invalid value.
  **/
-template <class IStream, class T, class Sections>
-Sections readDataArray (IStream& input, std::vector<T>& values, std::size_t max_size,
-                        Sections section, Sections parent_section)
+template <class T>
+void parseDataArray (std::string const& text, std::vector<T>& values, Vtk::ThreadPool& pool)
 {
-  values.reserve(max_size);
-  using S = std::conditional_t<(sizeof(T) <= 1), std::uint16_t, T>; // problem when reading chars as ints
+  char const* first = text.data();
+  char const* last = text.data() + text.size();
+
+  const std::size_t min_part_size = 1u << 20;
+  std::size_t num_parts = std::min(pool.size(), text.size() / min_part_size);
+  if (num_parts <= 1) {
+    Vtk::parseValues(first, last, values);
+    return;
+  }
 
-  std::size_t idx = 0;
-  for (std::string line; std::getline(input, line);) {
-    trim(line);
-    if (line.substr(1,10) == "/DataArray")
-      return parent_section;
-
-    std::istringstream stream(line);
-    S value;
-    for (; stream >> value; idx++)
-      values.push_back(T(value));
+  std::vector<char const*> bounds(num_parts+1, last);
+  bounds[0] = first;
+  for (std::size_t k = 1; k < num_parts; ++k) {
+    char const* pos = std::max(first + k*text.size()/num_parts, bounds[k-1]);
+    while (pos != last && !Vtk::Impl::isSpace(*pos))
+      ++pos;
+    bounds[k] = pos;
   }
 
-  return section;
+  std::vector<std::vector<T>> parts(num_parts);
+  pool.parallelFor(num_parts, [&](std::size_t k) {
+    Vtk::parseValues(bounds[k], bounds[k+1], parts[k], std::size_t(bounds[k] - first));
+  });
+  for (auto const& part : parts)
+    values.insert(values.end(), part.begin(), part.end());
+}
+
+// Return the vector to read values of type `S` into, i.e., `values` if the types match
+template <class S>
+std::vector<S>& selectBuffer (std::vector<S>& values, std::vector<S>& /*buffer*/)
+{
+  return values;
+}
+
+template <class S, class T>
+std::vector<S>& selectBuffer (std::vector<T>& /*values*/, std::vector<S>& buffer)
+{
+  return buffer;
 }
 // @}
 
 
 template <class Grid, class Creator>
-typename VtkReader<Grid,Creator>::Sections
-VtkReader<Grid,Creator>::readPoints (std::ifstream& input, std::string name)
+void VtkReader<Grid,Creator>::readPoints (std::string const& text, std::string /*name*/)
 {
   using T = typename GlobalCoordinate::value_type;
   assert(numberOfPoints_ > 0);
   assert(dataArray_["points"].components == 3u);
 
-  Sections sec;
-
   std::vector<T> point_values;
-  sec = readDataArray(input, point_values, 3*numberOfPoints_, POINTS_DATA_ARRAY, POINTS);
-  assert(sec == POINTS);
+  point_values.reserve(3*numberOfPoints_);
+  parseDataArray(text, point_values, threadPool());
   assert(point_values.size() == 3*numberOfPoints_);
 
   // extract points from continuous values
@@ -337,28 +338,52 @@ VtkReader<Grid,Creator>::readPoints (std::ifstream& input, std::string name)
     idx += (3u - p.size());
     vec_points.push_back(p);
   }
-
-  return sec;
 }
 
 
 template <class Grid, class Creator>
   template <class T>
-void VtkReader<Grid,Creator>::readPointsAppended (std::ifstream& input)
+void VtkReader<Grid,Creator>::readGridAppended (std::ifstream& input)
 {
   assert(numberOfPoints_ > 0);
   assert(dataArray_["points"].components == 3u);
+
+  // raw points in a mapped file are converted directly from the mapping
+  auto const& points_data = dataArray_["points"];
+  bool direct = mappedFile_ && points_data.format == Vtk::BINARY;
+
+  // read all DataArrays first and uncompress all blocks at once
+  std::vector<CompressedBlocks> compressed;
   std::vector<T> point_values;
-  readAppended(input, point_values, dataArray_["points"].offset);
-  assert(point_values.size() == 3*numberOfPoints_);
+  if (!direct)
+    readAppended(input, point_values, points_data, compressed);
+  readCellsAppended(input, compressed);
+  uncompressAppended(compressed);
+
+  assert(vec_connectivity.size() == std::size_t(vec_offsets.back()));
+
+  unsigned char const* source = nullptr;
+  if (direct) {
+    std::uint64_t pos = offset0_ + points_data.offset;
+    std::uint64_t size = 0;
+    std::memcpy(&size, mappedBytes(pos, sizeof(std::uint64_t)), sizeof(std::uint64_t));
+    assert(size == 3*numberOfPoints_*sizeof(T));
+    source = mappedBytes(pos + sizeof(std::uint64_t), size);
+  } else {
+    assert(point_values.size() == 3*numberOfPoints_);
+    source = reinterpret_cast<unsigned char const*>(point_values.data());
+  }
 
   // extract points from continuous values
   GlobalCoordinate p;
   vec_points.reserve(numberOfPoints_);
   std::size_t idx = 0;
   for (std::size_t i = 0; i < numberOfPoints_; ++i) {
-    for (std::size_t j = 0; j < p.size(); ++j)
-      p[j] = T(point_values[idx++]);
+    for (std::size_t j = 0; j < p.size(); ++j) {
+      T value; // the mapped data is not necessarily aligned
+      std::memcpy(&value, source + sizeof(T)*idx++, sizeof(T));
+      p[j] = value;
+    }
     idx += (3u - p.size());
     vec_points.push_back(p);
   }
@@ -366,17 +391,16 @@ void VtkReader<Grid,Creator>::readPointsAppended (std::ifstream& input)
 
 
 template <class Grid, class Creator>
-typename VtkReader<Grid,Creator>::Sections
-VtkReader<Grid,Creator>::readCells (std::ifstream& input, std::string name)
+void VtkReader<Grid,Creator>::readCells (std::string const& text, std::string name)
 {
-  Sections sec = CELLS_DATA_ARRAY;
-
   assert(numberOfCells_ > 0);
   if (name == "types") {
-    sec = readDataArray(input, vec_types, numberOfCells_, CELLS_DATA_ARRAY, CELLS);
+    vec_types.reserve(numberOfCells_);
+    parseDataArray(text, vec_types, threadPool());
     assert(vec_types.size() == numberOfCells_);
   } else if (name == "offsets") {
-    sec = readDataArray(input, vec_offsets, numberOfCells_, CELLS_DATA_ARRAY, CELLS);
+    vec_offsets.reserve(numberOfCells_);
+    parseDataArray(text, vec_offsets, threadPool());
     assert(vec_offsets.size() == numberOfCells_);
   } else if (name == "connectivity") {
     std::size_t max_size = 0;
@@ -385,18 +409,18 @@ VtkReader<Grid,Creator>::readCells (std::ifstream& input, std::string name)
       max_size = vec_offsets.back();
     else
       max_size = numberOfCells_ * max_vertices;
-    sec = readDataArray(input, vec_connectivity, max_size, CELLS_DATA_ARRAY, CELLS);
+    vec_connectivity.reserve(max_size);
+    parseDataArray(text, vec_connectivity, threadPool());
   } else if (name == "global_point_ids") {
-    sec = readDataArray(input, vec_point_ids, numberOfPoints_, CELLS_DATA_ARRAY, CELLS);
+    vec_point_ids.reserve(numberOfPoints_);
+    parseDataArray(text, vec_point_ids, threadPool());
     assert(vec_point_ids.size() == numberOfPoints_);
   }
-
-  return sec;
 }
 
 
 template <class Grid, class Creator>
-void VtkReader<Grid,Creator>::readCellsAppended (std::ifstream& input)
+void VtkReader<Grid,Creator>::readCellsAppended (std::ifstream& input, std::vector<CompressedBlocks>& compressed)
 {
   assert(numberOfCells_ > 0);
   auto types_data = dataArray_["types"];
@@ -404,21 +428,20 @@ void VtkReader<Grid,Creator>::readCellsAppended (std::ifstream& input)
   auto connectivity_data = dataArray_["connectivity"];
 
   assert(types_data.type == Vtk::UINT8);
-  readAppended(input, vec_types, types_data.offset);
+  readAppended(input, vec_types, types_data, compressed);
   assert(vec_types.size() == numberOfCells_);
 
   assert(dataArray_data.type == Vtk::INT64);
-  readAppended(input, vec_offsets, dataArray_data.offset);
+  readAppended(input, vec_offsets, dataArray_data, compressed);
   assert(vec_offsets.size() == numberOfCells_);
 
   assert(connectivity_data.type == Vtk::INT64);
-  readAppended(input, vec_connectivity, connectivity_data.offset);
-  assert(vec_connectivity.size() == std::size_t(vec_offsets.back()));
+  readAppended(input, vec_connectivity, connectivity_data, compressed);
 
   if (dataArray_.count("global_point_ids") > 0) {
     auto point_id_data = dataArray_["global_point_ids"];
     assert(point_id_data.type == Vtk::UINT64);
-    readAppended(input, vec_point_ids, point_id_data.offset);
+    readAppended(input, vec_point_ids, point_id_data, compressed);
     assert(vec_point_ids.size() == numberOfPoints_);
   }
 }
@@ -426,33 +449,27 @@ void VtkReader<Grid,Creator>::readCellsAppended (std::ifstream& input)
 
 // @{ implementation detail
 /**
- * Read compressed data into `buffer_in`, uncompress it and store the result in
- * the concrete-data-type `buffer`
+ * Uncompress the data in `buffer_in` and store the result in `buffer`
  * \param bs     Size of the uncompressed data
  * \param cbs    Size of the compressed data
- * \param input  Stream to read from.
  **/
-template <class T, class IStream>
-void read_compressed (T* buffer, unsigned char* buffer_in,
-                      std::uint64_t bs, std::uint64_t cbs, IStream& input)
+inline void uncompressBlock (unsigned char* buffer, unsigned char const* buffer_in,
+                             std::uint64_t bs, std::uint64_t cbs)
 {
 #if HAVE_VTK_ZLIB
   uLongf uncompressed_space = uLongf(bs);
   uLongf compressed_space = uLongf(cbs);
 
-  Bytef* compressed_buffer = reinterpret_cast<Bytef*>(buffer_in);
+  Bytef const* compressed_buffer = reinterpret_cast<Bytef const*>(buffer_in);
   Bytef* uncompressed_buffer = reinterpret_cast<Bytef*>(buffer);
 
-  input.read((char*)(compressed_buffer), compressed_space);
-  assert(uLongf(input.gcount()) == compressed_space);
-
   if (uncompress(uncompressed_buffer, &uncompressed_space, compressed_buffer, compressed_space) != Z_OK) {
     std::cerr << "Zlib error while uncompressing data.\n";
     std::abort();
   }
   assert(uLongf(bs) == uncompressed_space);
 #else
-  std::cerr << "Can not call read_compressed without compression enabled!\n";
+  std::cerr << "Can not call uncompressBlock without compression enabled!\n";
   std::abort();
 #endif
 }
@@ -461,9 +478,31 @@ void read_compressed (T* buffer, unsigned char* buffer_in,
 
 template <class Grid, class Creator>
   template <class T>
-void VtkReader<Grid,Creator>::readAppended (std::ifstream& input, std::vector<T>& values, std::uint64_t offset)
+void VtkReader<Grid,Creator>::readAppended (std::ifstream& input, std::vector<T>& values, DataArrayAttributes const& data)
 {
-  input.seekg(offset0_ + offset);
+  std::vector<CompressedBlocks> compressed;
+  readAppended(input, values, data, compressed);
+  uncompressAppended(compressed);
+}
+
+
+template <class Grid, class Creator>
+  template <class T>
+void VtkReader<Grid,Creator>::readAppended (std::ifstream& input, std::vector<T>& values, DataArrayAttributes const& data,
+                                            std::vector<CompressedBlocks>& compressed)
+{
+  // read from the mapped file if available, otherwise from the stream
+  std::uint64_t pos = offset0_ + data.offset;
+  auto read = [&](void* buffer, std::uint64_t n) {
+    if (mappedFile_)
+      std::memcpy(buffer, mappedBytes(pos, n), n);
+    else
+      input.read((char*)buffer, std::streamsize(n));
+    pos += n;
+  };
+
+  if (!mappedFile_)
+    input.seekg(pos);
 
   std::uint64_t size = 0;
 
@@ -473,10 +512,10 @@ void VtkReader<Grid,Creator>::readAppended (std::ifstream& input, std::vector<T>
   std::vector<std::uint64_t> cbs; // compressed block sizes
 
   // read total size / block-size(s)
-  if (format_ == Vtk::COMPRESSED) {
-    input.read((char*)&num_blocks, sizeof(std::uint64_t));
-    input.read((char*)&block_size, sizeof(std::uint64_t));
-    input.read((char*)&last_block_size, sizeof(std::uint64_t));
+  if (data.format == Vtk::COMPRESSED) {
+    read(&num_blocks, sizeof(std::uint64_t));
+    read(&block_size, sizeof(std::uint64_t));
+    read(&last_block_size, sizeof(std::uint64_t));
 
     assert(block_size % sizeof(T) == 0);
 
@@ -485,24 +524,35 @@ void VtkReader<Grid,Creator>::readAppended (std::ifstream& input, std::vector<T>
 
     // size of the compressed blocks
     cbs.resize(num_blocks);
-    input.read((char*)cbs.data(), num_blocks*sizeof(std::uint64_t));
+    read(cbs.data(), num_blocks*sizeof(std::uint64_t));
   } else {
-    input.read((char*)&size, sizeof(std::uint64_t));
+    read(&size, sizeof(std::uint64_t));
   }
   assert(size > 0 && (size % sizeof(T)) == 0);
   values.resize(size / sizeof(T));
 
-  if (format_ == Vtk::COMPRESSED) {
-    // upper bound for compressed block-size
-    std::uint64_t compressed_block_size = block_size + (block_size + 999)/1000 + 12;
-    // number of values in the full blocks
-    std::size_t num_values = block_size / sizeof(T);
-
-    std::vector<unsigned char> buffer_in(compressed_block_size);
-    for (std::size_t i = 0; i < std::size_t(num_blocks); ++i) {
-      std::uint64_t bs = i < std::size_t(num_blocks-1) ? block_size : last_block_size;
-      read_compressed(values.data() + i*num_values, buffer_in.data(), bs, cbs[i], input);
+  if (data.format == Vtk::COMPRESSED) {
+    // read all compressed blocks at once, uncompress later
+    CompressedBlocks blocks;
+    blocks.values = reinterpret_cast<unsigned char*>(values.data());
+    blocks.block_size = block_size;
+    blocks.last_block_size = last_block_size;
+    blocks.positions.resize(std::size_t(num_blocks) + 1, 0);
+    std::partial_sum(cbs.begin(), cbs.end(), std::next(blocks.positions.begin()));
+
+    if (mappedFile_) {
+      // uncompress directly from the mapping
+      blocks.source = mappedBytes(pos, blocks.positions.back());
+      mappedFile_->willNeed(pos, blocks.positions.back());
+    } else {
+      blocks.data.resize(std::size_t(blocks.positions.back()));
+      input.read((char*)(blocks.data.data()), std::streamsize(blocks.data.size()));
+      assert(input.gcount() == std::streamsize(blocks.data.size()));
     }
+
+    compressed.push_back(std::move(blocks));
+  } else if (mappedFile_) {
+    std::memcpy(values.data(), mappedBytes(pos, size), size);
   } else {
     input.read((char*)(values.data()), size);
     assert(input.gcount() == std::streamsize(size));
@@ -511,89 +561,108 @@ void VtkReader<Grid,Creator>::readAppended (std::ifstream& input, std::vector<T>
 
 
 template <class Grid, class Creator>
-void VtkReader<Grid,Creator>::createGrid (bool insertPieces)
+  template <class T>
+void VtkReader<Grid,Creator>::readFieldData (DataArrayAttributes const& data, std::size_t numEntities,
+                                             std::vector<T>& values)
 {
-  assert(vec_points.size() == numberOfPoints_);
-  assert(vec_types.size() == numberOfCells_);
-  assert(vec_offsets.size() == numberOfCells_);
+  if (filename_.empty())
+    DUNE_THROW(IOError, "DataArrays can only be read from a file opened with readFromFile().");
 
-  if (!vec_points.empty())
-    creator_.insertVertices(vec_points, vec_point_ids);
-  if (!vec_types.empty())
-    creator_.insertElements(vec_types, vec_offsets, vec_connectivity);
-  if (insertPieces)
-    creator_.insertPieces(pieces_);
+  std::ifstream input(filename_, std::ios_base::in | std::ios_base::binary);
+  if (!input.is_open())
+    DUNE_THROW(IOError, "File " << filename_ << " can not be opened!");
+
+  if (data.format != Vtk::ASCII && memoryMapping_) {
+    mappedFile_ = std::make_unique<Vtk::MappedFile>(filename_);
+    if (!mappedFile_->isOpen())
+      mappedFile_.reset();
+  }
+
+  switch (data.type) {
+    case Vtk::INT8:    readFieldData<std::int8_t>(input, data, values);   break;
+    case Vtk::UINT8:   readFieldData<std::uint8_t>(input, data, values);  break;
+    case Vtk::INT16:   readFieldData<std::int16_t>(input, data, values);  break;
+    case Vtk::UINT16:  readFieldData<std::uint16_t>(input, data, values); break;
+    case Vtk::INT32:   readFieldData<std::int32_t>(input, data, values);  break;
+    case Vtk::UINT32:  readFieldData<std::uint32_t>(input, data, values); break;
+    case Vtk::INT64:   readFieldData<std::int64_t>(input, data, values);  break;
+    case Vtk::UINT64:  readFieldData<std::uint64_t>(input, data, values); break;
+    case Vtk::FLOAT32: readFieldData<float>(input, data, values);         break;
+    case Vtk::FLOAT64: readFieldData<double>(input, data, values);        break;
+    default:
+      mappedFile_.reset();
+      DUNE_THROW(IOError, "Unknown data type of DataArray.");
+  }
+  mappedFile_.reset();
+
+  if (values.size() != numEntities * data.components)
+    DUNE_THROW(IOError, "DataArray has " << values.size() << " values, but " << numEntities
+      << " x " << data.components << " values are expected.");
 }
 
-// Assume input already read the line <AppendedData ...>
+
 template <class Grid, class Creator>
-std::uint64_t VtkReader<Grid,Creator>::findAppendedDataPosition (std::ifstream& input) const
+  template <class S, class T>
+void VtkReader<Grid,Creator>::readFieldData (std::ifstream& input, DataArrayAttributes const& data,
+                                             std::vector<T>& values)
 {
-  char c;
-  while (input.get(c) && std::isblank(c)) { /*do nothing*/ }
+  // read directly into `values` if no conversion is necessary
+  std::vector<S> buffer;
+  std::vector<S>& stored = selectBuffer(values, buffer);
+
+  if (data.format == Vtk::ASCII) {
+    input.seekg(std::streamoff(data.offset));
+    std::string text;
+    std::getline(input, text, '<');
+    stored.clear();
+    parseDataArray(text, stored, threadPool());
+  } else {
+    readAppended(input, stored, data);
+  }
 
-  std::uint64_t offset = input.tellg();
-  if (c != '_')
-    --offset; // if char is not '_', assume it is part of the data.
+  if (&stored == &buffer)
+    values.assign(buffer.begin(), buffer.end());
+}
 
-  return offset;
+
+template <class Grid, class Creator>
+void VtkReader<Grid,Creator>::uncompressAppended (std::vector<CompressedBlocks> const& compressed) const
+{
+  // list of all (array, block) pairs
+  std::vector<std::pair<std::size_t,std::size_t>> blocks;
+  for (std::size_t i = 0; i < compressed.size(); ++i)
+    for (std::size_t j = 0; j+1 < compressed[i].positions.size(); ++j)
+      blocks.emplace_back(i,j);
+
+  threadPool().parallelFor(blocks.size(), [&](std::size_t k)
+  {
+    auto const& array = compressed[blocks[k].first];
+    std::size_t j = blocks[k].second;
+    std::size_t num_blocks = array.positions.size() - 1;
+
+    std::uint64_t bs = j+1 < num_blocks ? array.block_size : array.last_block_size;
+    std::uint64_t cbs = array.positions[j+1] - array.positions[j];
+    unsigned char const* source = array.source ? array.source : array.data.data();
+    uncompressBlock(array.values + j*array.block_size, source + array.positions[j], bs, cbs);
+  });
 }
 
 
 template <class Grid, class Creator>
-std::map<std::string, std::string> VtkReader<Grid,Creator>::parseXml (std::string const& line, bool& closed)
+void VtkReader<Grid,Creator>::createGrid (bool insertPieces)
 {
-  closed = false;
-  std::map<std::string, std::string> attr;
-
-  Sections sec = NO_SECTION;
-  bool escape = false;
-
-  std::string name = "";
-  std::string value = "";
-  for (auto c : line) {
-    switch (sec) {
-    case NO_SECTION:
-      if (std::isalpha(c) || c == '_') {
-        name.clear();
-        sec = XML_NAME;
-        name.push_back(c);
-      } else if (c == '/') {
-        closed = true;
-      }
-      break;
-    case XML_NAME:
-      if (std::isalpha(c) || c == '_')
-        name.push_back(c);
-      else
-        sec = (c == '=' ? XML_NAME_ASSIGN : NO_SECTION);
-      break;
-    case XML_NAME_ASSIGN:
-      value.clear();
-      escape = false;
-      assert( c == '"' && "Format error!" );
-      sec = XML_VALUE;
-      break;
-    case XML_VALUE:
-      if (c == '"' && !escape) {
-        attr[name] = value;
-        sec = NO_SECTION;
-      } else if (c == '\\' && !escape) {
-        escape = true;
-      }  else {
-        value.push_back(c);
-        escape = false;
-      }
-      break;
-    default:
-      assert(false && "Format error!");
-    }
-  }
+  assert(vec_points.size() == numberOfPoints_);
+  assert(vec_types.size() == numberOfCells_);
+  assert(vec_offsets.size() == numberOfCells_);
 
-  return attr;
+  if (!vec_points.empty())
+    creator_.insertVertices(vec_points, vec_point_ids);
+  if (!vec_types.empty())
+    creator_.insertElements(vec_types, vec_offsets, vec_connectivity);
+  if (insertPieces)
+    creator_.insertPieces(pieces_);
 }
 
-
 template <class Grid, class Creator>
 void VtkReader<Grid,Creator>::clear ()
 {
@@ -603,7 +672,10 @@ void VtkReader<Grid,Creator>::clear ()
   vec_offsets.clear();
   vec_connectivity.clear();
   dataArray_.clear();
+  pointDataArrays_.clear();
+  cellDataArrays_.clear();
   pieces_.clear();
+  filename_.clear();
 
   numberOfCells_ = 0;
   numberOfPoints_ = 0;
@@ -45,7 +45,7 @@ void VtkTimeseriesWriter<W>
   auto tmp = tmpDir ? filesystem::path(*tmpDir) : tmpDir_;
   tmp /= name.string();
 
-  vtkWriter_.dataCollector_.update();
+  vtkWriter_.updateDataCollector();
 
   std::string filenameBase = tmp.string();
 
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <dune/common/hybridutilities.hh>
+#include <dune/vtk/forward.hh>
+#include <dune/vtk/typedvtkfunction.hh>
+#include <dune/vtk/vtktypes.hh>
+
+namespace Dune
+{
+  /// \brief VTK writer with a fixed set of statically typed point and cell fields
+  /**
+   * The fields passed to the constructor are stored with their concrete grid function type,
+   * see \ref TypedVtkFunction. In the appended (binary or compressed) format, the data
+   * collector is instantiated for each of these fields, so that the evaluation of the local
+   * functions is inlined and the values are converted directly to the output datatype.
+   * Fields added later by \ref VtkWriterInterface::addPointData and
+   * \ref VtkWriterInterface::addCellData are written after the typed fields, as usual.
+   *
+   * In the ASCII format and for aggregated pieces, the typed fields are written by their
+   * type-erased \ref VtkFunction.
+   *
+   * \tparam Writer  A VTK writer derived from \ref VtkWriterInterface, e.g. \ref VtkUnstructuredGridWriter
+   **/
+  template <template <class,class> class Writer, class GridView, class DataCollector,
+            class... PointFunctions, class... CellFunctions>
+  class VtkTypedWriter<Writer<GridView,DataCollector>, std::tuple<PointFunctions...>, std::tuple<CellFunctions...>>
+      : public Writer<GridView,DataCollector>
+  {
+    using Super = Writer<GridView,DataCollector>;
+    using Interface = VtkWriterInterface<GridView,DataCollector>;
+
+  public:
+    /// \brief Constructor, stores the gridView and the point and cell fields
+    /**
+     * \param gridView    Implementation of Dune::GridView
+     * \param pointFields Tuple of \ref Vtk::Field to be evaluated at the points
+     * \param cellFields  Tuple of \ref Vtk::Field to be evaluated at the cells
+     * \param format      Format of the VTK file, \see VtkWriterInterface
+     * \param datatype    Output datatype of the coordinates, \see VtkWriterInterface
+     **/
+    VtkTypedWriter (GridView const& gridView,
+                    std::tuple<Vtk::Field<PointFunctions>...> const& pointFields,
+                    std::tuple<Vtk::Field<CellFunctions>...> const& cellFields = {},
+                    Vtk::FormatTypes format = Vtk::BINARY,
+                    Vtk::DataTypes datatype = Vtk::FLOAT32)
+      : Super(gridView, format, datatype)
+      , pointFcts_(pointFields)
+      , cellFcts_(cellFields)
+    {
+      // the concrete writers redeclare the attached data private, so access it by the interface
+      Hybrid::forEach(pointFcts_, [&](auto const& fct) { this->Interface::pointData_.push_back(fct.erased()); });
+      Hybrid::forEach(cellFcts_, [&](auto const& fct) { this->Interface::cellData_.push_back(fct.erased()); });
+    }
+
+  protected:
+    // Write the typed fields first, then all other attached functions
+    virtual void writeDataAppended (std::ostream& out, std::vector<std::uint64_t>& blocks) const override
+    {
+      writeTypedFields(out, blocks, pointFcts_, this->Interface::pointData_, Interface::POINT_DATA);
+      writeTypedFields(out, blocks, cellFcts_, this->Interface::cellData_, Interface::CELL_DATA);
+    }
+
+  private:
+    template <class Fcts>
+    void writeTypedFields (std::ostream& out, std::vector<std::uint64_t>& blocks, Fcts const& typedFcts,
+                           std::vector<VtkFunction<GridView>> const& fcts, typename Interface::PositionTypes type) const
+    {
+      Hybrid::forEach(typedFcts, [&](auto const& fct) {
+        this->writeFieldsAppended(out, blocks, std::vector<std::decay_t<decltype(fct)>>{fct}, type);
+      });
+      std::vector<VtkFunction<GridView>> otherFcts(fcts.begin() + std::tuple_size<Fcts>::value, fcts.end());
+      this->writeFieldsAppended(out, blocks, otherFcts, type);
+    }
+
+  private:
+    std::tuple<TypedVtkFunction<GridView,PointFunctions>...> pointFcts_;
+    std::tuple<TypedVtkFunction<GridView,CellFunctions>...> cellFcts_;
+  };
+
+
+  /// \brief Create a \ref VtkTypedWriter with the point and cell fields `pointFields` and `cellFields`
+  /**
+   * Example:
+   * ```
+   * auto writer = makeVtkTypedWriter<VtkUnstructuredGridWriter<GridView>>(gridView,
+   *   std::make_tuple(Vtk::field(u, "u"), Vtk::field(grad_u, "grad_u", 3)));
+   * ```
+   **/
+  template <class Writer, class GridView, class... PointFunctions, class... CellFunctions>
+  auto makeVtkTypedWriter (GridView const& gridView,
+                           std::tuple<Vtk::Field<PointFunctions>...> const& pointFields,
+                           std::tuple<Vtk::Field<CellFunctions>...> const& cellFields = {},
+                           Vtk::FormatTypes format = Vtk::BINARY,
+                           Vtk::DataTypes datatype = Vtk::FLOAT32)
+  {
+    using W = VtkTypedWriter<Writer, std::tuple<PointFunctions...>, std::tuple<CellFunctions...>>;
+    return W(gridView, pointFields, cellFields, format, datatype);
+  }
+
+} // end namespace Dune
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstdint>
+#include <cstdlib>
+#include <iostream>
 #include <map>
 #include <string>
 #include <vector>
@@ -33,7 +35,8 @@ namespace Dune
 
     enum CellParametrization {
       LINEAR,
-      QUADRATIC
+      QUADRATIC,
+      LAGRANGE
     };
 
     enum CellTypes : std::uint8_t {
@@ -57,7 +60,15 @@ namespace Dune
       QUADRATIC_TRIANGLE   = 22,
       QUADRATIC_QUAD       = 23,
       QUADRATIC_TETRA      = 24,
-      QUADRATIC_HEXAHEDRON = 25
+      QUADRATIC_HEXAHEDRON = 25,
+      // Arbitrary order Lagrange VTK cell types
+      LAGRANGE_CURVE         = 68,
+      LAGRANGE_TRIANGLE      = 69,
+      LAGRANGE_QUADRILATERAL = 70,
+      LAGRANGE_TETRAHEDRON   = 71,
+      LAGRANGE_HEXAHEDRON    = 72,
+      LAGRANGE_WEDGE         = 73
+      /* LAGRANGE_PYRAMID       = 74, // not supported */
     };
     GeometryType to_geometry (std::uint8_t);
 
@@ -84,33 +95,120 @@ namespace Dune
     };
 
 
+    /// Static description of a VTK cell type, see \ref cellTypeInfo
+    struct CellTypeInfo
+    {
+      std::uint8_t type;    //< VTK cell type, 0 if the geometry type is not supported
+      int size;             //< number of nodes of the cell
+      bool noPermutation;   //< whether the permutation is the identity
+      int permutation[20];  //< VTK node j corresponds to the Dune node permutation[j]
+    };
+
+    /// \brief Return the description of the VTK cell type of the geometry type `t` with parametrization `p`
+    /**
+     * The descriptions are stored in a compile-time table indexed by the dimension and
+     * topology id of `t`, thus the lookup does neither allocate nor branch over the cell types.
+     * For the parametrization LAGRANGE, only the corners of the cell are described, since the
+     * number of nodes depends on the order, see \ref lagrangeNodes.
+     **/
+    inline CellTypeInfo const& cellTypeInfo (GeometryType const& t, CellParametrization p = LINEAR)
+    {
+      static constexpr CellTypeInfo table[3][13] = {
+        { // LINEAR
+          {VERTEX, 1, true, {0}},
+          {LINE, 2, true, {0,1}},
+          {0, 0, true, {}},
+          {TRIANGLE, 3, true, {0,1,2}},
+          {QUAD, 4, false, {0,1,3,2}},
+          {0, 0, true, {}},
+          {0, 0, true, {}},
+          {TETRA, 4, true, {0,1,2,3}},
+          {PYRAMID, 5, false, {0,1,3,2,4}},
+          {WEDGE, 6, false, {0,2,1,3,5,4}},
+          {HEXAHEDRON, 8, false, {0,1,3,2,4,5,7,6}},
+          {LINE, 2, true, {0,1}},                 // none, dim=1
+          {POLYGON, 20, true, {0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19}} // none, dim=2
+        },
+        { // QUADRATIC
+          {0, 0, true, {}},
+          {QUADRATIC_EDGE, 3, true, {0,1, 0}},
+          {0, 0, true, {}},
+          {QUADRATIC_TRIANGLE, 6, false, {0,1,2, 0,2,1}},
+          {QUADRATIC_QUAD, 8, false, {0,1,3,2, 2,1,3,0}},
+          {0, 0, true, {}},
+          {0, 0, true, {}},
+          {QUADRATIC_TETRA, 10, false, {0,1,2,3, 0,2,1,3,4,5}},
+          {0, 0, true, {}},
+          {0, 0, true, {}},
+          {QUADRATIC_HEXAHEDRON, 20, false, {0,1,3,2,4,5,7,6, 6,5,7,4,10,9,11,8,0,1,3,2}},
+          {0, 0, true, {}},
+          {0, 0, true, {}}
+        },
+        { // LAGRANGE
+          {0, 0, true, {}},
+          {LAGRANGE_CURVE, 2, true, {0,1}},
+          {0, 0, true, {}},
+          {LAGRANGE_TRIANGLE, 3, true, {0,1,2}},
+          {LAGRANGE_QUADRILATERAL, 4, false, {0,1,3,2}},
+          {0, 0, true, {}},
+          {0, 0, true, {}},
+          {LAGRANGE_TETRAHEDRON, 4, true, {0,1,2,3}},
+          {0, 0, true, {}},
+          {LAGRANGE_WEDGE, 6, false, {0,2,1,3,5,4}},
+          {LAGRANGE_HEXAHEDRON, 8, false, {0,1,3,2,4,5,7,6}},
+          {0, 0, true, {}},
+          {0, 0, true, {}}
+        }
+      };
+
+      // slots: vertex, line, -, triangle, quadrilateral, -, -, tetrahedron, pyramid, prism, hexahedron, none...
+      unsigned int slot = !t.isNone() ? (1u << t.dim()) - 1 + (t.id() >> 1)
+                        : (t.dim() == 1 || t.dim() == 2) ? 10 + t.dim() : 2;
+      return slot < 13 ? table[p][slot] : table[0][2];
+    }
+
+
     /// Mapping of Dune geometry types to VTK cell types
+    /**
+     * A lightweight handle to the static description returned by \ref cellTypeInfo.
+     **/
     class CellType
     {
     public:
-      CellType (GeometryType const& t, CellParametrization = LINEAR);
+      CellType (GeometryType const& t, CellParametrization parametrization = LINEAR)
+        : info_(&cellTypeInfo(t, parametrization))
+      {
+        if (info_->type == 0) {
+          std::cerr << "Geometry Type not supported by VTK!\n";
+          std::abort();
+        }
+      }
 
       /// Return VTK Cell type
       std::uint8_t type () const
       {
-        return type_;
+        return info_->type;
       }
 
       /// Return a permutation of Dune elemenr vertices to conform to VTK element numbering
       int permutation (int idx) const
       {
-        return permutation_[idx];
+        return info_->permutation[idx];
       }
 
       bool noPermutation () const
       {
-        return noPermutation_;
+        return info_->noPermutation;
+      }
+
+      /// Return the number of nodes of the VTK cell
+      int size () const
+      {
+        return info_->size;
       }
 
     private:
-      std::uint8_t type_;
-      std::vector<int> permutation_;
-      bool noPermutation_;
+      CellTypeInfo const* info_;
     };
 
 
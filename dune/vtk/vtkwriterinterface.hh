@@ -1,15 +1,24 @@
 #pragma once
 
+#include <array>
+#include <future>
 #include <iosfwd>
 #include <map>
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#include <dune/common/exceptions.hh>
 #include <dune/common/std/optional.hh>
 #include <dune/vtk/filewriter.hh>
 #include <dune/vtk/forward.hh>
 #include <dune/vtk/vtkfunction.hh>
 #include <dune/vtk/vtktypes.hh>
+#include <dune/vtk/utility/aggregatedpiece.hh>
+#include <dune/vtk/utility/derivedfield.hh>
+#include <dune/vtk/utility/taskqueue.hh>
+#include <dune/vtk/utility/threadpool.hh>
 
 namespace Dune
 {
@@ -70,6 +79,27 @@ namespace Dune
      **/
     virtual void write (std::string const& fn, Std::optional<std::string> dir = {}) const override;
 
+    /// \brief Write the serial file of this partition to the output stream `out`
+    /**
+     * All sizes and offsets are computed before anything is written to `out`, so the
+     * file is written strictly front to back and the stream need not be seekable, e.g.,
+     * a pipe or a compressing stream, \see setSequential.
+     **/
+    void write (std::ostream& out) const;
+
+    /// \brief Write the attached data to the file in a background thread
+    /**
+     * Blocks only until the point coordinates, cells and data values are collected. These
+     * are encoded, compressed and written to the file in a background thread, in the order
+     * of submission. The parameters are the same as in \ref write.
+     *
+     * Returns a future that becomes ready when the files are written. At most
+     * \ref setMaxPendingWrites writes are pending at the same time; a further call blocks
+     * until the oldest one is finished. If a file can not be written, `get()` on the future
+     * throws an IOError.
+     **/
+    virtual std::future<void> writeAsync (std::string const& fn, Std::optional<std::string> dir = {}) const;
+
     /// \brief Attach point data to the writer
     /**
      * Attach a global function to the writer that will be evaluated at grid points
@@ -77,78 +107,282 @@ namespace Dune
      * assignable to the function wrapper \ref VtkFunction. Additional argument
      * for output datatype and number of components can be bassed. See \ref VtkFunction
      * Constructor for possible arguments.
+     *
+     * Instead of a global function, a container of values indexed by the vertex index can be
+     * passed, e.g., a `std::vector<double>` or a `BlockVector<FieldVector<double,3>>`, see
+     * \ref Vtk::IsIndexedContainer. The values are copied directly to the points at the
+     * vertices, without binding a local function. The container is stored by reference,
+     * thus temporary containers can not be attached.
      **/
     template <class Function, class... Args>
     VtkWriterInterface& addPointData (Function const& fct, Args&&... args)
     {
-      pointData_.emplace_back(fct, std::forward<Args>(args)...);
+      pointData_.push_back(makeFunction(fct, dimension, std::forward<Args>(args)...));
       return *this;
     }
 
+    template <class Container, class... Args,
+      std::enable_if_t<!std::is_lvalue_reference<Container>::value && Vtk::IsIndexedContainer<Container>::value, int> = 0>
+    VtkWriterInterface& addPointData (Container&& values, Args&&... args) = delete;
+
     /// \brief Attach cell data to the writer
     /**
      * Attach a global function to the writer that will be evaluated at cell centers.
      * The global function must be assignable to the function wrapper \ref VtkFunction.
      * Additional argument for output datatype and number of components can be bassed.
      * See \ref VtkFunction Constructor for possible arguments.
+     *
+     * Instead of a global function, a container of values indexed by the element index can
+     * be passed, see \ref addPointData.
      **/
     template <class Function, class... Args>
     VtkWriterInterface& addCellData (Function const& fct, Args&&... args)
     {
-      cellData_.emplace_back(fct, std::forward<Args>(args)...);
+      cellData_.push_back(makeFunction(fct, 0, std::forward<Args>(args)...));
+      return *this;
+    }
+
+    template <class Container, class... Args,
+      std::enable_if_t<!std::is_lvalue_reference<Container>::value && Vtk::IsIndexedContainer<Container>::value, int> = 0>
+    VtkWriterInterface& addCellData (Container&& values, Args&&... args) = delete;
+
+    /// \brief Attach point data computed from point data attached before
+    /**
+     * The `derived` field, e.g., \ref Vtk::magnitude or \ref Vtk::component, names its sources,
+     * which must have been attached by \ref addPointData before. In the appended formats, the
+     * values are computed from the arrays of the sources collected in the same write, without
+     * evaluating the functions again. The datatype defaults to that of the first source.
+     **/
+    VtkWriterInterface& addDerivedPointData (Vtk::DerivedField const& derived, std::string name,
+                                             Std::optional<Vtk::DataTypes> type = {})
+    {
+      pointData_.push_back(makeDerivedFunction(pointData_, derived, std::move(name), type));
+      return *this;
+    }
+
+    /// \brief Attach cell data computed from cell data attached before, \see addDerivedPointData
+    VtkWriterInterface& addDerivedCellData (Vtk::DerivedField const& derived, std::string name,
+                                            Std::optional<Vtk::DataTypes> type = {})
+    {
+      cellData_.push_back(makeDerivedFunction(cellData_, derived, std::move(name), type));
+      return *this;
+    }
+
+    /// \brief Set the number of threads used to compress the appended data blocks
+    /**
+     * By default, the data is compressed in the calling thread. If several MPI ranks
+     * share one node, the number of threads should be chosen such that the ranks together
+     * do not use more threads than cores, see \ref Vtk::ThreadPool::defaultNumThreads.
+     * A value of 1 disables the multi-threaded compression.
+     **/
+    VtkWriterInterface& setNumThreads (std::size_t numThreads)
+    {
+      threadPool_ = std::make_shared<Vtk::ThreadPool>(numThreads);
+      return *this;
+    }
+
+    /// \brief Collect the points, cells and data with the threads used for compression
+    /**
+     * The elements are split into chunks that are processed in parallel by the data
+     * collector, see \ref DataCollectorInterface::setThreadPool. The grid must allow
+     * concurrent read access. The output does not depend on the number of threads.
+     **/
+    VtkWriterInterface& setThreadedCollection (bool enable = true)
+    {
+      threadedCollection_ = enable;
+      return *this;
+    }
+
+    /// \brief Evaluate all attached point-data and all cell-data in one traversal of the grid
+    /**
+     * The local functions of all fields are bound to each element in turn, instead of
+     * traversing the grid once per field, see \ref DataCollectorInterface::pointDataFused.
+     * The values of all fields are stored at the same time in double precision, thus the
+     * memory for the data arrays is not bounded by the chunk size anymore.
+     **/
+    VtkWriterInterface& setFusedCollection (bool enable = true)
+    {
+      fusedCollection_ = enable;
       return *this;
     }
 
+    /// \brief Set the maximal number of asynchronous writes that are pending at the same time
+    /// \see writeAsync
+    VtkWriterInterface& setMaxPendingWrites (std::size_t maxPending)
+    {
+      maxPendingWrites_ = maxPending;
+      if (taskQueue_)
+        taskQueue_->setMaxPending(maxPending);
+      return *this;
+    }
+
+    /// \brief Write all files strictly front to back
+    /**
+     * By default, placeholders for the offsets and block sizes are written first and
+     * filled in by seeking back in the file. In sequential mode, the XML part is written
+     * to memory first, with the offsets computed from the number of values of the raw
+     * appended arrays, and the arrays are streamed to the file afterwards. Compressed
+     * arrays have to be stored in memory, since their size is known only after compression.
+     * This avoids random writes, e.g., on parallel file systems.
+     **/
+    VtkWriterInterface& setSequential (bool enable = true)
+    {
+      sequential_ = enable;
+      return *this;
+    }
+
+    /// \brief Enable or disable caching of the mesh arrays between writes
+    /**
+     * If enabled, the collected point ids and the encoded (possibly compressed) points
+     * and cells are stored after the first write and reused in subsequent writes, as long
+     * as the grid is not modified. Then, only the point-data and cell-data is evaluated
+     * and encoded again. A modification of the grid is detected by the number of entities
+     * of each codimension and the maximal grid level. A change of the vertex coordinates
+     * only, e.g., in a moving-mesh simulation, is not detected. In that case call
+     * \ref invalidateMeshCache() after the grid is changed.
+     **/
+    VtkWriterInterface& setMeshCaching (bool enable = true)
+    {
+      meshCache_.enabled = enable;
+      invalidateMeshCache();
+      return *this;
+    }
+
+    /// Clear the cached mesh arrays, so that these are collected again in the next write
+    void invalidateMeshCache ()
+    {
+      meshCache_.valid = false;
+      meshCache_.clear();
+    }
+
   private:
     /// Write a serial VTK file in Unstructured format
-    virtual void writeSerialFile (std::ofstream& out) const = 0;
+    virtual void writeSerialFile (std::ostream& out) const = 0;
 
     /// Write a parallel VTK file `pfilename.pvtx` in XML format,
     /// with `size` the number of pieces and serial files given by `pfilename_p[i].vtu`
     /// for [i] in [0,...,size).
-    virtual void writeParallelFile (std::ofstream& out, std::string const& pfilename, int size) const = 0;
+    virtual void writeParallelFile (std::ostream& out, std::string const& pfilename, int size) const = 0;
 
     /// Return the file extension of the serial file (not including the dot)
     virtual std::string fileExtension () const = 0;
 
     /// Write points and cells in raw/compressed format to output stream
-    virtual void writeGridAppended (std::ofstream& out, std::vector<std::uint64_t>& blocks) const = 0;
+    virtual void writeGridAppended (std::ostream& out, std::vector<std::uint64_t>& blocks) const = 0;
+
+    // Wrap the global function `fct` in a \ref VtkFunction
+    template <class Function, class... Args,
+      std::enable_if_t<!Vtk::IsIndexedContainer<Function>::value, int> = 0>
+    VtkFunction makeFunction (Function const& fct, int /*codim*/, Args&&... args) const
+    {
+      return VtkFunction(fct, std::forward<Args>(args)...);
+    }
+
+    // Wrap the `values` attached to the entities of codimension `codim` in a \ref VtkFunction
+    template <class Container, class... Args,
+      std::enable_if_t<Vtk::IsIndexedContainer<Container>::value, int> = 0>
+    VtkFunction makeFunction (Container const& values, int codim, Args&&... args) const
+    {
+      auto const& gridView = dataCollector_.gridView();
+      if (std::size_t(values.size()) != std::size_t(gridView.size(codim)))
+        DUNE_THROW(RangeError, "Container of size " << values.size() << " does not match the number "
+          << gridView.size(codim) << " of entities of codimension " << codim << ".");
+      return VtkFunction(gridView, Vtk::IndexedValues(values, codim), std::forward<Args>(args)...);
+    }
+
+    // Look up the sources of the `derived` field in `fcts` and wrap it in a \ref VtkFunction
+    VtkFunction makeDerivedFunction (std::vector<VtkFunction> const& fcts, Vtk::DerivedField const& derived,
+                                     std::string name, Std::optional<Vtk::DataTypes> type) const;
 
   protected:
+    /// Write the serial file to the output stream front to back, \see setSequential
+    void writeSerialFileSequential (std::ostream& out) const;
+
+    /// Return the names of the serial file, the parallel file, and the serial file
+    /// relative to the parallel file, all without partition suffix and extension.
+    std::array<std::string,3> filenames (std::string const& fn, Std::optional<std::string> dir) const;
+
+    // Update the DataCollector on the current GridView. If the mesh cache is valid, i.e.,
+    // the grid is unchanged since the last write, the update of unstructured data
+    // collectors is skipped. Otherwise, the cache is cleared.
+    void updateDataCollector () const;
+
+    // Return the global point ids of the DataCollector. The ids are collected once and
+    // stored in the mesh cache until the next update of the DataCollector.
+    std::vector<std::uint64_t> const& pointIds () const;
+
     // Write the point or cell values given by the grid function `fct` to the
     // output stream `out`. In case of binary format, append the streampos of XML
     // attributes "offset" to the vector `offsets`.
-    void writeData (std::ofstream& out,
+    void writeData (std::ostream& out,
                     std::vector<pos_type>& offsets,
                     VtkFunction const& fct,
                     PositionTypes type,
                     Std::optional<std::size_t> timestep = {}) const;
 
     // Write point-data and cell-data in raw/compressed format to output stream
-    void writeDataAppended (std::ofstream& out, std::vector<std::uint64_t>& blocks) const;
+    virtual void writeDataAppended (std::ostream& out, std::vector<std::uint64_t>& blocks) const;
+
+    // Write the values of the functions `fcts` at the points or cells, depending on `type`, in
+    // raw/compressed format to the output stream. `Function` is \ref VtkFunction or a function
+    // with the same interface, e.g. \ref TypedVtkFunction. Derived fields whose sources are
+    // in `fcts` are computed from the collected arrays of the sources.
+    template <class Function>
+    void writeFieldsAppended (std::ostream& out, std::vector<std::uint64_t>& blocks,
+                              std::vector<Function> const& fcts, PositionTypes type) const;
 
     // Write the coordinates of the vertices to the output stream `out`. In case
     // of binary format, appends the streampos of XML attributes "offset" to the
     // vector `offsets`.
-    void writePoints (std::ofstream& out,
+    void writePoints (std::ostream& out,
                       std::vector<pos_type>& offsets,
                       Std::optional<std::size_t> timestep = {}) const;
 
+    // Write a DataArray element with the XML `attributes`. In ASCII format, the values are
+    // written by `writeValues()`. Otherwise, the streampos of the XML attribute "offset" is
+    // appended to the vector `offsets`.
+    template <class WriteValues>
+    void writeDataArray (std::ostream& out,
+                         std::vector<pos_type>& offsets,
+                         std::string const& attributes,
+                         Std::optional<std::size_t> timestep,
+                         WriteValues const& writeValues) const;
+
+    // Return the XML attributes of the DataArray of the point coordinates
+    std::string pointsAttributes () const;
+
+    // Return the XML attributes of the DataArray of the function `fct`
+    std::string dataAttributes (VtkFunction const& fct) const;
+
     // Write Appended section and fillin offset values to XML attributes
-    void writeAppended (std::ofstream& out, std::vector<pos_type> const& offsets) const;
+    void writeAppended (std::ostream& out, std::vector<pos_type> const& offsets) const;
+
+    // Write the grid arrays, or copy them from the mesh cache, and the data arrays in
+    // raw/compressed format to the output stream. Append the written sizes to `blocks`.
+    // If \ref piece_ is set, its data arrays are written instead of the point-data and cell-data.
+    void writeAppendedArrays (std::ostream& out, std::vector<std::uint64_t>& blocks) const;
 
     // Write the `values` in blocks (possibly compressed) to the output
-    // stream `out`. Return the written block size.
+    // stream `out`. Return the written block size. Compressed blocks are
+    // created in parallel using the \ref threadPool().
     template <class T>
-    std::uint64_t writeValuesAppended (std::ofstream& out, std::vector<T> const& values) const;
+    std::uint64_t writeValuesAppended (std::ostream& out, std::vector<T> const& values) const;
+
+    // Write `num_values` values of type `T` in blocks (possibly compressed) to the output
+    // stream `out`. The values are produced in chunks by `producer(sink)` that must call
+    // `sink(T const* data, std::size_t n)` for consecutive chunks. Only a few blocks are
+    // stored at once. Return the written block size.
+    template <class T, class Producer>
+    std::uint64_t writeValuesAppended (std::ostream& out, std::uint64_t num_values,
+                                       Producer const& producer) const;
 
     // Write the `values` in a space and newline separated list of ascii representations.
     // The precision is controlled by the datatype and numerical_limits::digits10.
     template <class T>
-    void writeValuesAscii (std::ofstream& out, std::vector<T> const& values) const;
+    void writeValuesAscii (std::ostream& out, std::vector<T> const& values) const;
 
     // Write the XML file header of a VTK file `<VTKFile ...>`
-    void writeHeader (std::ofstream& out, std::string const& type) const;
+    void writeHeader (std::ostream& out, std::string const& type) const;
 
     /// Return PointData/CellData attributes for the name of the first scalar/vector/tensor DataArray
     std::string getNames (std::vector<VtkFunction> const& data) const;
@@ -178,6 +412,68 @@ namespace Dune
       return datatype_;
     }
 
+    // Returns the number of values of type `T` passed at once to the block writer,
+    // i.e., one block per thread
+    template <class T>
+    std::size_t chunkSize () const
+    {
+      return threadPool().size() * block_size / sizeof(T);
+    }
+
+    // Data of a serial file that is collected in the foreground and written in the
+    // background, see \ref writeAsync. The XML part contains placeholders for the
+    // offsets of the appended data arrays.
+    struct DeferredFile
+    {
+      std::string head;                             // XML part of the file
+      std::size_t appended_pos = 0;                 // position of the appended data in `head`
+      std::vector<pos_type> offsets;                // positions of the offset placeholders
+
+      std::string encoded;                          // already encoded arrays, from the mesh cache
+      std::vector<std::uint64_t> encoded_blocks;    // sizes of the encoded arrays
+      std::vector<std::vector<unsigned char>> arrays; // raw arrays to be encoded
+
+      bool collect = true;                          // if false, record only the sizes of the
+      std::vector<std::uint64_t> sizes;             // raw arrays, without evaluating them
+    };
+
+    // Encode the arrays of `file`, fill in the offsets and write the file to `out`
+    static void writeDeferredFile (std::ostream& out, DeferredFile const& file,
+                                   Vtk::FormatTypes format, std::uint64_t block_size,
+                                   int level, Vtk::ThreadPool& pool);
+
+    // Encode the arrays of `file` and return the appended data. The sizes of all
+    // arrays, including the already encoded ones, are stored in `blocks`.
+    static std::string encodeDeferredArrays (DeferredFile const& file, std::vector<std::uint64_t>& blocks,
+                                             Vtk::FormatTypes format, std::uint64_t block_size,
+                                             int level, Vtk::ThreadPool& pool);
+
+    // Fill in the offsets of the appended arrays with sizes `blocks` at the placeholder
+    // `positions` in the XML part `head`. The first array starts at `offset`.
+    static void fillOffsets (std::string& head, std::vector<pos_type> const& positions,
+                             std::vector<std::uint64_t> const& blocks, std::uint64_t offset = 0);
+
+    // Write the XML part of the serial file and collect its raw appended arrays, to be
+    // encoded and written by \ref submitFiles
+    std::shared_ptr<DeferredFile> collectDeferredFile () const;
+
+    // Write the parallel file with `size` pieces to a string, \see writeParallelFile
+    std::string parallelFileString (std::string const& pfilename, int size) const;
+
+    // Write the serial `file` to `serial_fn` and the `parallel` file to `parallel_fn` in
+    // the background. Null files are skipped.
+    std::future<void> submitFiles (std::string const& serial_fn, std::shared_ptr<DeferredFile> file,
+                                   std::string const& parallel_fn, std::shared_ptr<std::string> parallel) const;
+
+    // Returns the thread pool used for compression
+    Vtk::ThreadPool& threadPool () const
+    {
+      return threadPool_ ? *threadPool_ : Vtk::ThreadPool::defaultPool();
+    }
+
+    // Return a key that identifies the grid and its modification state
+    std::vector<std::size_t> meshKey () const;
+
     // Return the global MPI communicator.
     auto comm () const
     {
@@ -196,6 +492,45 @@ namespace Dune
 
     std::size_t const block_size = 1024*32;
     int compression_level = -1; // in [0,9], -1 ... use default value
+    bool sequential_ = false;
+    bool threadedCollection_ = false;
+    bool fusedCollection_ = false;
+
+    // thread pool to compress blocks in parallel. If not set, the default pool is used.
+    std::shared_ptr<Vtk::ThreadPool> threadPool_ = nullptr;
+
+    // background thread for asynchronous writes, created on first use
+    mutable std::shared_ptr<Vtk::TaskQueue> taskQueue_ = nullptr;
+    std::size_t maxPendingWrites_ = 2;
+
+    // if set, the appended arrays, or their sizes, are collected in this file instead of being written
+    mutable DeferredFile* deferred_ = nullptr;
+
+    // if set, the arrays of this piece, e.g., merged from several partitions, are written
+    // instead of the values of the data collector
+    mutable Vtk::AggregatedPiece const* piece_ = nullptr;
+
+    // mesh arrays stored between writes, see \ref setMeshCaching
+    struct MeshCache
+    {
+      bool enabled = false;
+      bool valid = false;
+      std::vector<std::size_t> key;
+
+      Std::optional<std::vector<std::uint64_t>> pointIds;
+      std::string appended;               // encoded grid arrays of the appended section
+      std::vector<std::uint64_t> blocks;  // sizes of the encoded grid arrays
+
+      void clear ()
+      {
+        key.clear();
+        pointIds = Std::nullopt;
+        appended.clear();
+        blocks.clear();
+      }
+    };
+
+    mutable MeshCache meshCache_;
   };
 
 
@@ -7,37 +7,202 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <utility>
 
 #if HAVE_VTK_ZLIB
 #include <zlib.h>
 #endif
 
+#include <dune/common/std/type_traits.hh>
 #include <dune/geometry/referenceelements.hh>
 #include <dune/geometry/type.hh>
 
+#include <dune/vtk/utility/charconv.hh>
 #include <dune/vtk/utility/enum.hh>
 #include <dune/vtk/utility/filesystem.hh>
 #include <dune/vtk/utility/string.hh>
 
 namespace Dune {
 
+namespace Impl {
+
+// Compress `bs` bytes from `buffer` into `buffer_out` that has a capacity of
+// `cbs` bytes. Return the compressed size.
+inline std::uint64_t compressBlock (unsigned char const* buffer, unsigned char* buffer_out,
+                                    std::uint64_t bs, std::uint64_t cbs, int level)
+{
+#if HAVE_VTK_ZLIB
+  uLongf uncompressed_space = uLongf(bs);
+  uLongf compressed_space = uLongf(cbs);
+
+  Bytef* out = reinterpret_cast<Bytef*>(buffer_out);
+  Bytef const* in = reinterpret_cast<Bytef const*>(buffer);
+
+  if (compress2(out, &compressed_space, in, uncompressed_space, level) != Z_OK) {
+    std::cerr << "Zlib error while compressing data.\n";
+    std::abort();
+  }
+
+  return compressed_space;
+#else
+  std::cerr << "Can not call compressBlock without compression enabled!\n";
+  std::abort();
+  return 0;
+#endif
+}
+
+} // end namespace Impl
+
+namespace Impl {
+
+// Write a stream of bytes in blocks (possibly compressed) to an output stream. The
+// header with the block sizes is written first and filled in by \ref finish().
+class AppendedBlockWriter
+{
+public:
+  // Write the header for `size` bytes of data to the stream `out`
+  AppendedBlockWriter (std::ostream& out, Vtk::FormatTypes format, std::uint64_t size,
+                       std::uint64_t block_size, int level, Vtk::ThreadPool& pool)
+    : out_(out)
+    , format_(format)
+    , size_(size)
+    , block_size_(block_size)
+    , compressed_block_size_(block_size + (block_size + 999)/1000 + 12)
+    , level_(level)
+    , pool_(pool)
+  {
+    std::uint64_t num_full_blocks = size / block_size;
+    std::uint64_t last_block_size = size % block_size;
+    std::uint64_t num_blocks = num_full_blocks + (last_block_size > 0 ? 1 : 0);
+
+    // write block-size(s)
+    std::uint64_t zero = 0;
+    if (format_ == Vtk::COMPRESSED) {
+      begin_pos_ = out.tellp();
+      out.write((char*)&num_blocks, sizeof(std::uint64_t));
+      out.write((char*)&block_size, sizeof(std::uint64_t));
+      out.write((char*)&last_block_size, sizeof(std::uint64_t));
+      for (std::uint64_t i = 0; i < num_blocks; ++i)
+        out.write((char*)&zero, sizeof(std::uint64_t));
+
+      // The blocks are compressed in batches of a few blocks per thread
+      batch_size_ = std::min(std::size_t(num_blocks), 4*pool.size());
+      cbs_.reserve(std::size_t(num_blocks));
+      pending_.reserve(std::size_t(block_size));
+    } else {
+      out.write((char*)&size, sizeof(std::uint64_t));
+    }
+  }
+
+  // Append `n` bytes of `data` to the stream
+  void write (unsigned char const* data, std::uint64_t n)
+  {
+    written_ += n;
+    assert(written_ <= size_);
+    if (format_ != Vtk::COMPRESSED) {
+      out_.write((char const*)data, std::streamsize(n));
+      return;
+    }
+
+    // complete the block started in a previous call
+    if (!pending_.empty()) {
+      std::uint64_t m = std::min<std::uint64_t>(n, block_size_ - pending_.size());
+      pending_.insert(pending_.end(), data, data + m);
+      data += m;
+      n -= m;
+      if (pending_.size() < block_size_)
+        return;
+      blocks_.push_back(pending_.data());
+    }
+
+    // full blocks are compressed directly from `data`
+    for (; n >= block_size_; data += block_size_, n -= block_size_) {
+      blocks_.push_back(data);
+      if (blocks_.size() == batch_size_)
+        writeBlocks(block_size_);
+    }
+    writeBlocks(block_size_);
+
+    pending_.assign(data, data + n);
+  }
+
+  // Write the last block and the compressed block sizes. Return the number of bytes written.
+  // Only for compressed data, the stream must be seekable.
+  std::uint64_t finish ()
+  {
+    assert(written_ == size_);
+    if (format_ != Vtk::COMPRESSED)
+      return sizeof(std::uint64_t) + size_;
+
+    if (!pending_.empty()) {
+      blocks_.push_back(pending_.data());
+      writeBlocks(pending_.size());
+      pending_.clear();
+    }
+
+    auto end_pos = out_.tellp();
+    out_.seekp(begin_pos_ + std::streamoff(3*sizeof(std::uint64_t)));
+    out_.write((char*)cbs_.data(), std::streamsize(cbs_.size()*sizeof(std::uint64_t)));
+    out_.seekp(end_pos);
+
+    return std::uint64_t(end_pos - begin_pos_);
+  }
+
+private:
+  // Compress the collected blocks in parallel and write them in order. All blocks
+  // have size `block_size_`, except the last one that has size `last_block_size`.
+  void writeBlocks (std::uint64_t last_block_size)
+  {
+    if (blocks_.empty())
+      return;
+
+    buffers_.resize(blocks_.size());
+    std::size_t first = cbs_.size();
+    cbs_.resize(first + blocks_.size());
+    pool_.parallelFor(blocks_.size(), [&](std::size_t k)
+    {
+      std::uint64_t bs = k+1 < blocks_.size() ? block_size_ : last_block_size;
+      buffers_[k].resize(std::size_t(compressed_block_size_));
+      cbs_[first+k] = compressBlock(blocks_[k], buffers_[k].data(), bs,
+                                    compressed_block_size_, level_);
+    });
+
+    for (std::size_t k = 0; k < blocks_.size(); ++k)
+      out_.write((char*)buffers_[k].data(), std::streamsize(cbs_[first+k]));
+    blocks_.clear();
+  }
+
+private:
+  std::ostream& out_;
+  Vtk::FormatTypes format_;
+  std::uint64_t size_;
+  std::uint64_t block_size_;
+  std::uint64_t compressed_block_size_;
+  int level_;
+  Vtk::ThreadPool& pool_;
+  std::ostream::pos_type begin_pos_ = 0;
+
+  std::uint64_t written_ = 0;
+  std::size_t batch_size_ = 0;
+  std::vector<std::uint64_t> cbs_;               // compressed block sizes
+  std::vector<unsigned char const*> blocks_;     // blocks to be compressed
+  std::vector<std::vector<unsigned char>> buffers_; // compressed blocks
+  std::vector<unsigned char> pending_;           // incomplete block
+};
+
+} // end namespace Impl
+
+
 template <class GV, class DC>
 void VtkWriterInterface<GV,DC>
   ::write (std::string const& fn, Std::optional<std::string> dir) const
 {
-  dataCollector_.update();
-
-  auto p = filesystem::path(fn);
-  auto name = p.stem();
-  p.remove_filename();
+  updateDataCollector();
 
-  filesystem::path fn_dir = p;
-  filesystem::path data_dir = dir ? filesystem::path(*dir) : fn_dir;
-  filesystem::path rel_dir = filesystem::relative(data_dir, fn_dir);
-
-  std::string serial_fn = data_dir.string() + '/' + name.string();
-  std::string parallel_fn = fn_dir.string() + '/' + name.string();
-  std::string rel_fn = rel_dir.string() + '/' + name.string();
+  auto fns = filenames(fn, dir);
+  std::string serial_fn = fns[0];
+  std::string const& parallel_fn = fns[1];
+  std::string const& rel_fn = fns[2];
 
   if (comm().size() > 1)
     serial_fn += "_p" + std::to_string(comm().rank());
@@ -51,7 +216,10 @@ void VtkWriterInterface<GV,DC>
       ? std::numeric_limits<float>::digits10+2
       : std::numeric_limits<double>::digits10+2);
 
-    writeSerialFile(serial_out);
+    if (sequential_)
+      writeSerialFileSequential(serial_out);
+    else
+      writeSerialFile(serial_out);
   }
 
   if (comm().size() > 1 && comm().rank() == 0) {
@@ -69,46 +237,349 @@ void VtkWriterInterface<GV,DC>
 }
 
 
+template <class GV, class DC>
+std::future<void> VtkWriterInterface<GV,DC>
+  ::writeAsync (std::string const& fn, Std::optional<std::string> dir) const
+{
+  updateDataCollector();
+
+  auto fns = filenames(fn, dir);
+  std::string serial_fn = fns[0] + "." + fileExtension();
+  if (comm().size() > 1)
+    serial_fn = fns[0] + "_p" + std::to_string(comm().rank()) + "." + fileExtension();
+  std::string parallel_fn = fns[1] + ".p" + fileExtension();
+
+  // collect the XML part and the raw appended arrays of the serial file
+  auto file = collectDeferredFile();
+
+  // the parallel file is small and contains no data, so write it to a string directly
+  std::shared_ptr<std::string> parallel = nullptr;
+  if (comm().size() > 1 && comm().rank() == 0)
+    parallel = std::make_shared<std::string>(parallelFileString(fns[2], comm().size()));
+
+  return submitFiles(serial_fn, file, parallel_fn, parallel);
+}
+
+
+template <class GV, class DC>
+std::shared_ptr<typename VtkWriterInterface<GV,DC>::DeferredFile> VtkWriterInterface<GV,DC>
+  ::collectDeferredFile () const
+{
+  auto file = std::make_shared<DeferredFile>();
+
+  std::stringstream head(std::ios::in | std::ios::out | std::ios::binary);
+  head.imbue(std::locale::classic());
+  head << std::setprecision(datatype_ == Vtk::FLOAT32
+    ? std::numeric_limits<float>::digits10+2
+    : std::numeric_limits<double>::digits10+2);
+
+  deferred_ = file.get();
+  try {
+    writeSerialFile(head);
+  } catch (...) {
+    deferred_ = nullptr;
+    throw;
+  }
+  deferred_ = nullptr;
+  file->head = head.str();
+  return file;
+}
+
+
+template <class GV, class DC>
+std::string VtkWriterInterface<GV,DC>
+  ::parallelFileString (std::string const& pfilename, int size) const
+{
+  std::ostringstream parallel_out(std::ios::binary);
+  parallel_out.imbue(std::locale::classic());
+  parallel_out << std::setprecision(datatype_ == Vtk::FLOAT32
+    ? std::numeric_limits<float>::digits10+2
+    : std::numeric_limits<double>::digits10+2);
+
+  writeParallelFile(parallel_out, pfilename, size);
+  return parallel_out.str();
+}
+
+
+template <class GV, class DC>
+std::future<void> VtkWriterInterface<GV,DC>
+  ::submitFiles (std::string const& serial_fn, std::shared_ptr<DeferredFile> file,
+                 std::string const& parallel_fn, std::shared_ptr<std::string> parallel) const
+{
+  if (!taskQueue_)
+    taskQueue_ = std::make_shared<Vtk::TaskQueue>(maxPendingWrites_);
+
+  // NOTE: the task must not access the writer, since it might be modified in the meantime
+  auto pool = threadPool_;
+  auto format = format_;
+  std::uint64_t bs = block_size;
+  int level = compression_level;
+  // NOTE: errors are reported by the returned future only, so throw instead of asserting
+  return taskQueue_->submit([=]
+  {
+    if (file) {
+      std::ofstream serial_out(serial_fn, std::ios_base::ate | std::ios::binary);
+      if (!serial_out.is_open())
+        DUNE_THROW(IOError, "Could not open file " << serial_fn << " for writing.");
+      writeDeferredFile(serial_out, *file, format, bs, level, pool ? *pool : Vtk::ThreadPool::defaultPool());
+      if (!serial_out.flush())
+        DUNE_THROW(IOError, "Could not write file " << serial_fn << ".");
+    }
+
+    if (parallel) {
+      std::ofstream parallel_out(parallel_fn, std::ios_base::ate | std::ios::binary);
+      if (!parallel_out.is_open())
+        DUNE_THROW(IOError, "Could not open file " << parallel_fn << " for writing.");
+      parallel_out.write(parallel->data(), std::streamsize(parallel->size()));
+      if (!parallel_out.flush())
+        DUNE_THROW(IOError, "Could not write file " << parallel_fn << ".");
+    }
+  });
+}
+
+
 template <class GV, class DC>
 void VtkWriterInterface<GV,DC>
-  ::writeData (std::ofstream& out, std::vector<pos_type>& offsets,
-               VtkFunction const& fct, PositionTypes type,
-               Std::optional<std::size_t> timestep) const
+  ::writeDeferredFile (std::ostream& out, DeferredFile const& file, Vtk::FormatTypes format,
+                       std::uint64_t block_size, int level, Vtk::ThreadPool& pool)
 {
-  out << "<DataArray Name=\"" << fct.name() << "\" type=\"" << to_string(fct.type()) << "\""
-      << " NumberOfComponents=\"" << fct.ncomps() << "\" format=\"" << (format_ == Vtk::ASCII ? "ascii\"" : "appended\"");
-  if (timestep)
-    out << " TimeStep=\"" << *timestep << "\"";
+  std::vector<std::uint64_t> blocks;
+  std::string appended = encodeDeferredArrays(file, blocks, format, block_size, level, pool);
 
+  std::string head = file.head;
+  fillOffsets(head, file.offsets, blocks);
+
+  out.write(head.data(), std::streamsize(file.appended_pos));
+  out.write(appended.data(), std::streamsize(appended.size()));
+  out.write(head.data() + file.appended_pos, std::streamsize(head.size() - file.appended_pos));
+}
+
+
+template <class GV, class DC>
+std::string VtkWriterInterface<GV,DC>
+  ::encodeDeferredArrays (DeferredFile const& file, std::vector<std::uint64_t>& blocks,
+                          Vtk::FormatTypes format, std::uint64_t block_size,
+                          int level, Vtk::ThreadPool& pool)
+{
+  blocks = file.encoded_blocks;
+  std::stringstream buffer(std::ios::in | std::ios::out | std::ios::binary);
+  buffer.write(file.encoded.data(), std::streamsize(file.encoded.size()));
+  for (auto const& values : file.arrays) {
+    Impl::AppendedBlockWriter writer(buffer, format, values.size(), block_size, level, pool);
+    writer.write(values.data(), values.size());
+    blocks.push_back(writer.finish());
+  }
+  return buffer.str();
+}
+
+
+template <class GV, class DC>
+void VtkWriterInterface<GV,DC>
+  ::fillOffsets (std::string& head, std::vector<pos_type> const& positions,
+                 std::vector<std::uint64_t> const& blocks, std::uint64_t offset)
+{
+  assert(positions.size() <= blocks.size());
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    std::string value = '"' + std::to_string(offset) + '"';
+    head.replace(std::size_t(positions[i]), value.size(), value);
+    offset += blocks[i];
+  }
+}
+
+
+template <class GV, class DC>
+std::array<std::string,3> VtkWriterInterface<GV,DC>
+  ::filenames (std::string const& fn, Std::optional<std::string> dir) const
+{
+  auto p = filesystem::path(fn);
+  auto name = p.stem();
+  p.remove_filename();
+
+  filesystem::path fn_dir = p;
+  filesystem::path data_dir = dir ? filesystem::path(*dir) : fn_dir;
+  filesystem::path rel_dir = filesystem::relative(data_dir, fn_dir);
+
+  std::string serial_fn = data_dir.string() + '/' + name.string();
+  std::string parallel_fn = fn_dir.string() + '/' + name.string();
+  std::string rel_fn = rel_dir.string() + '/' + name.string();
+
+  return {serial_fn, parallel_fn, rel_fn};
+}
+
+
+template <class GV, class DC>
+void VtkWriterInterface<GV,DC>
+  ::write (std::ostream& out) const
+{
+  updateDataCollector();
+
+  std::locale loc = out.imbue(std::locale::classic());
+  std::streamsize precision = out.precision(datatype_ == Vtk::FLOAT32
+    ? std::numeric_limits<float>::digits10+2
+    : std::numeric_limits<double>::digits10+2);
+
+  writeSerialFileSequential(out);
+
+  out.imbue(loc);
+  out.precision(precision);
+}
+
+
+template <class GV, class DC>
+void VtkWriterInterface<GV,DC>
+  ::writeSerialFileSequential (std::ostream& out) const
+{
+  // ASCII files contain no offsets
   if (format_ == Vtk::ASCII) {
-    out << ">\n";
+    writeSerialFile(out);
+    return;
+  }
+
+  // write the XML part and record only the sizes of the raw appended arrays
+  DeferredFile file;
+  file.collect = false;
+  {
+    std::stringstream head(std::ios::in | std::ios::out | std::ios::binary);
+    head.imbue(out.getloc());
+    head.precision(out.precision());
+
+    deferred_ = &file;
+    try {
+      writeSerialFile(head);
+    } catch (...) {
+      deferred_ = nullptr;
+      throw;
+    }
+    deferred_ = nullptr;
+    file.head = head.str();
+  }
+
+  // The size of raw arrays is known in advance. Compressed arrays are written to a
+  // buffer first, since their size is known only after compression.
+  std::vector<std::uint64_t> blocks;
+  std::string appended;
+  if (format_ == Vtk::COMPRESSED) {
+    std::ostringstream buffer(std::ios::binary);
+    writeAppendedArrays(buffer, blocks);
+    appended = buffer.str();
+  } else {
+    blocks = file.encoded_blocks;
+    blocks.insert(blocks.end(), file.sizes.begin(), file.sizes.end());
+  }
+
+  fillOffsets(file.head, file.offsets, blocks);
+  out.write(file.head.data(), std::streamsize(file.appended_pos));
+  if (format_ == Vtk::COMPRESSED)
+    out.write(appended.data(), std::streamsize(appended.size()));
+  else {
+    std::vector<std::uint64_t> written;
+    writeAppendedArrays(out, written);
+    assert(written == blocks);
+  }
+  out.write(file.head.data() + file.appended_pos, std::streamsize(file.head.size() - file.appended_pos));
+}
+
+
+namespace Impl {
+
+  template <class DC>
+  using HasCells = decltype(std::declval<DC const&>().cells());
+
+} // end namespace Impl
+
+
+template <class GV, class DC>
+void VtkWriterInterface<GV,DC>
+  ::updateDataCollector () const
+{
+  bool valid = false;
+  if (meshCache_.enabled) {
+    auto key = meshKey();
+    // all ranks must agree, since collecting the mesh might need communication
+    valid = comm().min(int(meshCache_.valid && key == meshCache_.key)) == 1;
+    if (!valid) {
+      meshCache_.clear();
+      meshCache_.key = std::move(key);
+    }
+  } else {
+    meshCache_.clear();
+  }
+
+  dataCollector_.setThreadPool(threadedCollection_ ? &threadPool() : nullptr);
+
+  // NOTE: structured data collectors exchange the grid extents in the update.
+  if (!valid || !Std::is_detected<Impl::HasCells, DC>::value)
+    dataCollector_.update();
+
+  meshCache_.valid = meshCache_.enabled;
+}
+
+
+template <class GV, class DC>
+std::vector<std::size_t> VtkWriterInterface<GV,DC>
+  ::meshKey () const
+{
+  auto const& gridView = dataCollector_.gridView();
+  std::vector<std::size_t> key;
+  key.push_back(reinterpret_cast<std::uintptr_t>(&gridView.grid()));
+  key.push_back(std::size_t(gridView.grid().maxLevel()));
+  for (int codim = 0; codim <= dimension; ++codim)
+    key.push_back(std::size_t(gridView.size(codim)));
+  return key;
+}
+
+
+template <class GV, class DC>
+std::vector<std::uint64_t> const& VtkWriterInterface<GV,DC>
+  ::pointIds () const
+{
+  if (!meshCache_.pointIds)
+    meshCache_.pointIds = dataCollector_.pointIds();
+  return *meshCache_.pointIds;
+}
+
+
+template <class GV, class DC>
+void VtkWriterInterface<GV,DC>
+  ::writeData (std::ostream& out, std::vector<pos_type>& offsets,
+               VtkFunction const& fct, PositionTypes type,
+               Std::optional<std::size_t> timestep) const
+{
+  writeDataArray(out, offsets, dataAttributes(fct), timestep, [&]
+  {
     if (type == POINT_DATA)
       writeValuesAscii(out, dataCollector_.template pointData<double>(fct));
     else
       writeValuesAscii(out, dataCollector_.template cellData<double>(fct));
-    out << "</DataArray>\n";
-  } else {
-    out << " offset=";
-    offsets.push_back(out.tellp());
-    out << std::string(std::numeric_limits<std::uint64_t>::digits10 + 2, ' ');
-    out << "/>\n";
-  }
+  });
 }
 
 
 template <class GV, class DC>
 void VtkWriterInterface<GV,DC>
-  ::writePoints (std::ofstream& out, std::vector<pos_type>& offsets,
+  ::writePoints (std::ostream& out, std::vector<pos_type>& offsets,
                 Std::optional<std::size_t> timestep) const
 {
-  out << "<DataArray type=\"" << to_string(datatype_) << "\""
-      << " NumberOfComponents=\"3\" format=\"" << (format_ == Vtk::ASCII ? "ascii\"" : "appended\"");
+  writeDataArray(out, offsets, pointsAttributes(), timestep, [&]
+  {
+    writeValuesAscii(out, dataCollector_.template points<double>());
+  });
+}
+
+
+template <class GV, class DC>
+  template <class WriteValues>
+void VtkWriterInterface<GV,DC>
+  ::writeDataArray (std::ostream& out, std::vector<pos_type>& offsets, std::string const& attributes,
+                    Std::optional<std::size_t> timestep, WriteValues const& writeValues) const
+{
+  out << "<DataArray" << attributes << " format=\"" << (format_ == Vtk::ASCII ? "ascii\"" : "appended\"");
   if (timestep)
     out << " TimeStep=\"" << *timestep << "\"";
 
   if (format_ == Vtk::ASCII) {
     out << ">\n";
-    writeValuesAscii(out, dataCollector_.template points<double>());
+    writeValues();
     out << "</DataArray>\n";
   } else {
     out << " offset=";
@@ -118,33 +589,198 @@ void VtkWriterInterface<GV,DC>
   }
 }
 
+
+template <class GV, class DC>
+std::string VtkWriterInterface<GV,DC>
+  ::pointsAttributes () const
+{
+  return " type=\"" + to_string(datatype_) + "\" NumberOfComponents=\"3\"";
+}
+
+
+template <class GV, class DC>
+std::string VtkWriterInterface<GV,DC>
+  ::dataAttributes (VtkFunction const& fct) const
+{
+  return " Name=\"" + fct.name() + "\" type=\"" + to_string(fct.type()) + "\""
+       + " NumberOfComponents=\"" + std::to_string(fct.ncomps()) + "\"";
+}
+
+template <class GV, class DC>
+typename VtkWriterInterface<GV,DC>::VtkFunction VtkWriterInterface<GV,DC>
+  ::makeDerivedFunction (std::vector<VtkFunction> const& fcts, Vtk::DerivedField const& derived,
+                         std::string name, Std::optional<Vtk::DataTypes> type) const
+{
+  std::vector<VtkFunction> sources;
+  for (auto const& source : derived.sources()) {
+    auto it = std::find_if(fcts.rbegin(), fcts.rend(), [&](VtkFunction const& f) { return f.name() == source; });
+    if (it == fcts.rend())
+      DUNE_THROW(RangeError, "Source '" << source << "' of derived field '" << name << "' is not attached.");
+    if (!sources.empty() && it->ncomps() != sources.front().ncomps())
+      DUNE_THROW(RangeError, "Sources of derived field '" << name << "' differ in the number of components.");
+    sources.push_back(*it);
+  }
+
+  if (derived.operation() == Vtk::DerivedField::COMPONENT && derived.comp() >= sources.front().ncomps())
+    DUNE_THROW(RangeError, "Component " << derived.comp() << " of derived field '" << name << "' exceeds the "
+      << sources.front().ncomps() << " components of '" << sources.front().name() << "'.");
+
+  return VtkFunction(derived, sources, std::move(name), type);
+}
+
+
+template <class GV, class DC>
+void VtkWriterInterface<GV,DC>
+  ::writeDataAppended (std::ostream& out, std::vector<std::uint64_t>& blocks) const
+{
+  writeFieldsAppended(out, blocks, pointData_, POINT_DATA);
+  writeFieldsAppended(out, blocks, cellData_, CELL_DATA);
+}
+
+
 template <class GV, class DC>
+  template <class Function>
 void VtkWriterInterface<GV,DC>
-  ::writeDataAppended (std::ofstream& out, std::vector<std::uint64_t>& blocks) const
+  ::writeFieldsAppended (std::ostream& out, std::vector<std::uint64_t>& blocks,
+                         std::vector<Function> const& fcts, PositionTypes type) const
 {
-  for (auto const& v : pointData_) {
-    blocks.push_back( v.type() == Vtk::FLOAT32
-      ? this->writeValuesAppended(out, dataCollector_.template pointData<float>(v))
-      : this->writeValuesAppended(out, dataCollector_.template pointData<double>(v)));
+  if (deferred_ && !deferred_->collect) {
+    // only the sizes of the arrays are recorded, so nothing needs to be evaluated
+    for (auto const& fct : fcts) {
+      std::uint64_t num = (type == POINT_DATA ? dataCollector_.numPoints() : dataCollector_.numCells()) * fct.ncomps();
+      if (fct.type() == Vtk::FLOAT32)
+        writeValuesAppended<float>(out, num, [](auto&&) {});
+      else
+        writeValuesAppended<double>(out, num, [](auto&&) {});
+    }
+    return;
+  }
+
+  // positions of the sources of each derived field, if all of them are written before it
+  std::vector<std::vector<std::size_t>> sources(fcts.size());
+  std::vector<bool> isSource(fcts.size(), false);
+  for (std::size_t i = 0; i < fcts.size(); ++i) {
+    Vtk::DerivedField const* derived = fcts[i].derived();
+    if (!derived)
+      continue;
+    for (auto const& name : derived->sources()) {
+      // the last function with this name before the derived field
+      std::size_t j = i;
+      while (j > 0 && fcts[j-1].name() != name)
+        --j;
+      if (j == 0 || (!sources[i].empty() && fcts[j-1].ncomps() != fcts[sources[i].front()].ncomps())) {
+        sources[i].clear();
+        break;
+      }
+      sources[i].push_back(j-1);
+    }
+    for (std::size_t j : sources[i])
+      isSource[j] = true;
+  }
+
+  // convert the collected values chunk-wise to the output type and write them
+  auto writeValues = [&](auto t, std::vector<double> const& values) {
+    using T = decltype(t);
+    return this->template writeValuesAppended<T>(out, values.size(), [&](auto&& sink) {
+      std::size_t n = this->template chunkSize<T>();
+      std::vector<T> chunk;
+      for (std::size_t i = 0; i < values.size(); i += n) {
+        chunk.assign(values.begin() + i, values.begin() + std::min(i + n, values.size()));
+        sink(chunk.data(), chunk.size());
+      }
+    });
+  };
+
+  // write the collected values of fcts[i], keep them only if a derived field needs them
+  std::vector<std::vector<double>> values(fcts.size());
+  auto writeCollected = [&](std::size_t i) {
+    blocks.push_back(fcts[i].type() == Vtk::FLOAT32 ? writeValues(float{}, values[i]) : writeValues(double{}, values[i]));
+    if (!isSource[i])
+      std::vector<double>{}.swap(values[i]);
+  };
+
+  // compute the values of the derived field fcts[i] from the values of its sources
+  auto derive = [&](std::size_t i) {
+    std::vector<double const*> ptrs;
+    for (std::size_t j : sources[i])
+      ptrs.push_back(values[j].data());
+    int ncomps = fcts[sources[i].front()].ncomps();
+    std::size_t n = values[sources[i].front()].size() / ncomps;
+    values[i].resize(n * fcts[i].ncomps());
+    fcts[i].derived()->apply(ptrs.data(), n, ncomps, values[i].data());
+  };
+
+  if (fusedCollection_ && fcts.size() > 1) {
+    // collect all fields first, then convert and write the arrays one after another
+    std::vector<Function> collected;
+    std::vector<std::size_t> positions;
+    for (std::size_t i = 0; i < fcts.size(); ++i) {
+      if (sources[i].empty()) {
+        collected.push_back(fcts[i]);
+        positions.push_back(i);
+      }
+    }
+
+    auto collectedValues = type == POINT_DATA
+      ? dataCollector_.template pointDataFused<double>(collected)
+      : dataCollector_.template cellDataFused<double>(collected);
+    for (std::size_t k = 0; k < positions.size(); ++k)
+      values[positions[k]] = std::move(collectedValues[k]);
+
+    for (std::size_t i = 0; i < fcts.size(); ++i) {
+      if (!sources[i].empty())
+        derive(i);
+      writeCollected(i);
+    }
+    return;
   }
-  for (auto const& v : cellData_) {
-    blocks.push_back( v.type() == Vtk::FLOAT32
-      ? this->writeValuesAppended(out, dataCollector_.template cellData<float>(v))
-      : this->writeValuesAppended(out, dataCollector_.template cellData<double>(v)));
+
+  auto writeChunked = [&](auto t, Function const& fct) {
+    using T = decltype(t);
+    std::uint64_t num = type == POINT_DATA ? dataCollector_.numPoints() : dataCollector_.numCells();
+    return this->template writeValuesAppended<T>(out, num * fct.ncomps(), [&](auto&& sink) {
+      if (type == POINT_DATA)
+        dataCollector_.template pointDataChunked<T>(fct, sink, this->template chunkSize<T>());
+      else
+        dataCollector_.template cellDataChunked<T>(fct, sink, this->template chunkSize<T>());
+    });
+  };
+
+  for (std::size_t i = 0; i < fcts.size(); ++i) {
+    if (!sources[i].empty()) {
+      derive(i);
+      writeCollected(i);
+    } else if (isSource[i]) {
+      // the values are needed by a derived field, so store them
+      values[i] = type == POINT_DATA
+        ? dataCollector_.template pointData<double>(fcts[i])
+        : dataCollector_.template cellData<double>(fcts[i]);
+      writeCollected(i);
+    } else {
+      blocks.push_back(fcts[i].type() == Vtk::FLOAT32 ? writeChunked(float{}, fcts[i]) : writeChunked(double{}, fcts[i]));
+    }
   }
 }
 
 
 template <class GV, class DC>
 void VtkWriterInterface<GV,DC>
-  ::writeAppended (std::ofstream& out, std::vector<pos_type> const& offsets) const
+  ::writeAppended (std::ostream& out, std::vector<pos_type> const& offsets) const
 {
   if (is_a(format_, Vtk::APPENDED)) {
     out << "<AppendedData encoding=\"raw\">\n_";
+    if (deferred_) {
+      // only collect the arrays, these are written by \ref writeDeferredFile
+      deferred_->appended_pos = std::size_t(out.tellp());
+      deferred_->offsets = offsets;
+    }
+
     std::vector<std::uint64_t> blocks;
-    writeGridAppended(out, blocks);
-    writeDataAppended(out, blocks);
+    writeAppendedArrays(out, blocks);
     out << "</AppendedData>\n";
+    if (deferred_)
+      return;
+
     pos_type appended_pos = out.tellp();
 
     pos_type offset = 0;
@@ -159,33 +795,76 @@ void VtkWriterInterface<GV,DC>
 }
 
 
-namespace Impl {
-
-  template <class T, std::enable_if_t<(sizeof(T)>1), int> = 0>
-  inline T const& printable (T const& t) { return t; }
-
-  inline std::int16_t printable (std::int8_t c) { return std::int16_t(c); }
-  inline std::uint16_t printable (std::uint8_t c) { return std::uint16_t(c); }
+template <class GV, class DC>
+void VtkWriterInterface<GV,DC>
+  ::writeAppendedArrays (std::ostream& out, std::vector<std::uint64_t>& blocks) const
+{
+  if (meshCache_.enabled) {
+    // encode the grid arrays once and copy the bytes in subsequent writes
+    if (meshCache_.blocks.empty()) {
+      auto deferred = std::exchange(deferred_, nullptr);
+      std::ostringstream buffer(std::ios::binary);
+      writeGridAppended(buffer, meshCache_.blocks);
+      meshCache_.appended = buffer.str();
+      deferred_ = deferred;
+    }
+    if (deferred_) {
+      if (deferred_->collect)
+        deferred_->encoded = meshCache_.appended;
+      deferred_->encoded_blocks = meshCache_.blocks;
+    } else {
+      out.write(meshCache_.appended.data(), std::streamsize(meshCache_.appended.size()));
+      blocks = meshCache_.blocks;
+    }
+  } else {
+    writeGridAppended(out, blocks);
+  }
 
-} // end namespace Impl
+  if (piece_) {
+    for (std::size_t i = Vtk::AggregatedPiece::NUM_GRID_ARRAYS; i < piece_->arrays.size(); ++i)
+      blocks.push_back(writeValuesAppended(out, piece_->arrays[i]));
+  } else {
+    writeDataAppended(out, blocks);
+  }
+}
 
 
 template <class GV, class DC>
   template <class T>
 void VtkWriterInterface<GV,DC>
-  ::writeValuesAscii (std::ofstream& out, std::vector<T> const& values) const
+  ::writeValuesAscii (std::ostream& out, std::vector<T> const& values) const
 {
   assert(is_a(format_, Vtk::ASCII) && "Function should by called only in ascii mode!\n");
-  std::size_t i = 0;
-  for (auto const& v : values)
-    out << Impl::printable(v) << (++i % 6 != 0 ? ' ' : '\n');
-  if (i % 6 != 0)
+
+  // The values are formatted in chunks of full lines in parallel and written in order
+  const std::size_t values_per_line = 6;
+  const std::size_t chunk_size = values_per_line * 2048;
+  const int precision = int(out.precision());
+
+  auto& pool = threadPool();
+  std::size_t num_chunks = (values.size() + chunk_size - 1) / chunk_size;
+  std::size_t batch_size = std::min(num_chunks, 4*pool.size());
+
+  std::vector<std::string> buffers(batch_size);
+  for (std::size_t first = 0; first < num_chunks; first += batch_size) {
+    std::size_t n = std::min(batch_size, num_chunks - first);
+    pool.parallelFor(n, [&](std::size_t k) {
+      std::size_t begin = (first + k) * chunk_size;
+      Vtk::formatValues(buffers[k], values.data() + begin, std::min(chunk_size, values.size() - begin),
+                        precision, values_per_line);
+    });
+
+    for (std::size_t k = 0; k < n; ++k)
+      out.write(buffers[k].data(), std::streamsize(buffers[k].size()));
+  }
+
+  if (values.size() % values_per_line != 0)
     out << '\n';
 }
 
 template <class GV, class DC>
 void VtkWriterInterface<GV,DC>
-  ::writeHeader (std::ofstream& out, std::string const& type) const
+  ::writeHeader (std::ostream& out, std::string const& type) const
 {
   out << "<VTKFile"
       << " type=\"" << type << "\""
@@ -199,98 +878,45 @@ void VtkWriterInterface<GV,DC>
 }
 
 
-namespace Impl {
-
-template <class T>
-std::uint64_t writeValuesToBuffer (std::size_t max_num_values, unsigned char* buffer,
-                                   std::vector<T> const& vec, std::size_t shift)
-{
-  std::size_t num_values = std::min(max_num_values, vec.size()-shift);
-  std::uint64_t bs = num_values*sizeof(T);
-  std::memcpy(buffer, (unsigned char*)(vec.data()+shift), std::size_t(bs));
-  return bs;
-}
-
-
-template <class OStream>
-std::uint64_t writeCompressed (unsigned char const* buffer, unsigned char* buffer_out,
-                               std::uint64_t bs, std::uint64_t cbs, int level, OStream& outb)
+template <class GV, class DC>
+  template <class T>
+std::uint64_t VtkWriterInterface<GV,DC>
+  ::writeValuesAppended (std::ostream& out, std::vector<T> const& values) const
 {
-#if HAVE_VTK_ZLIB
-  uLongf uncompressed_space = uLongf(bs);
-  uLongf compressed_space = uLongf(cbs);
-
-  Bytef* out = reinterpret_cast<Bytef*>(buffer_out);
-  Bytef const* in = reinterpret_cast<Bytef const*>(buffer);
-
-  if (compress2(out, &compressed_space, in, uncompressed_space, level) != Z_OK) {
-    std::cerr << "Zlib error while compressing data.\n";
-    std::abort();
-  } else {
-    outb.write((char*)out, compressed_space);
-  }
-
-  return compressed_space;
-#else
-  std::cerr << "Can not call writeCompressed without compression enabled!\n";
-  std::abort();
-  return 0;
-#endif
+  return writeValuesAppended<T>(out, values.size(), [&values](auto&& sink) {
+    sink(values.data(), values.size());
+  });
 }
 
-} // end namespace Impl
 
 template <class GV, class DC>
-  template <class T>
+  template <class T, class Producer>
 std::uint64_t VtkWriterInterface<GV,DC>
-  ::writeValuesAppended (std::ofstream& out, std::vector<T> const& values) const
+  ::writeValuesAppended (std::ostream& out, std::uint64_t num_values, Producer const& producer) const
 {
   assert(is_a(format_, Vtk::APPENDED) && "Function should by called only in appended mode!\n");
-  pos_type begin_pos = out.tellp();
-
-  std::uint64_t size = values.size() * sizeof(T);
 
-  std::uint64_t num_full_blocks = size / block_size;
-  std::uint64_t last_block_size = size % block_size;
-  std::uint64_t num_blocks = num_full_blocks + (last_block_size > 0 ? 1 : 0);
-
-  // write block-size(s)
-  std::uint64_t zero = 0;
-  if (format_ == Vtk::COMPRESSED) {
-    out.write((char*)&num_blocks, sizeof(std::uint64_t));
-    out.write((char*)&block_size, sizeof(std::uint64_t));
-    out.write((char*)&last_block_size, sizeof(std::uint64_t));
-    for (std::uint64_t i = 0; i < num_blocks; ++i)
-      out.write((char*)&zero, sizeof(std::uint64_t));
-  } else {
-    out.write((char*)&size, sizeof(std::uint64_t));
-  }
-
-  std::uint64_t compressed_block_size = block_size + (block_size + 999)/1000 + 12;
-  std::vector<unsigned char> buffer(block_size);
-  std::vector<unsigned char> buffer_out;
-  std::size_t num_values = block_size / sizeof(T);
-
-  std::vector<std::uint64_t> cbs(std::size_t(num_blocks), 0); // compressed block sizes
-  for (std::size_t i = 0; i < std::size_t(num_blocks); ++i) {
-    std::uint64_t bs = Impl::writeValuesToBuffer<T>(num_values, buffer.data(), values, i*num_values);
-
-    if (format_ == Vtk::COMPRESSED) {
-      buffer_out.resize(std::size_t(compressed_block_size));
-      cbs[i] = Impl::writeCompressed(buffer.data(), buffer_out.data(), bs,
-                                     compressed_block_size, compression_level, out);
-    } else
-      out.write((char*)buffer.data(), bs);
-  }
-
-  pos_type end_pos = out.tellp();
-  if (format_ == Vtk::COMPRESSED) {
-    out.seekp(begin_pos + std::streamoff(3*sizeof(std::uint64_t)));
-    out.write((char*)cbs.data(), std::streamsize(num_blocks*sizeof(std::uint64_t)));
-    out.seekp(end_pos);
+  if (deferred_ && !deferred_->collect) {
+    deferred_->sizes.push_back(sizeof(std::uint64_t) + num_values*sizeof(T));
+    return 0;
+  } else if (deferred_) {
+    // collect the raw values to be encoded in the background
+    deferred_->arrays.emplace_back();
+    auto& bytes = deferred_->arrays.back();
+    bytes.reserve(std::size_t(num_values*sizeof(T)));
+    producer([&bytes](T const* data, std::size_t n) {
+      auto first = reinterpret_cast<unsigned char const*>(data);
+      bytes.insert(bytes.end(), first, first + n*sizeof(T));
+    });
+    return 0;
   }
 
-  return std::uint64_t(end_pos - begin_pos);
+  Impl::AppendedBlockWriter writer(out, format_, num_values*sizeof(T), block_size,
+                                   compression_level, threadPool());
+  producer([&writer](T const* data, std::size_t n) {
+    writer.write(reinterpret_cast<unsigned char const*>(data), n*sizeof(T));
+  });
+  return writer.finish();
 }
 
 
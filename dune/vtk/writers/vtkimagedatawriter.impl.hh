@@ -18,7 +18,7 @@ namespace Dune {
 
 template <class GV, class DC>
 void VtkImageDataWriter<GV,DC>
-  ::writeSerialFile (std::ofstream& out) const
+  ::writeSerialFile (std::ostream& out) const
 {
   std::vector<pos_type> offsets; // pos => offset
   this->writeHeader(out, "ImageData");
@@ -58,7 +58,7 @@ void VtkImageDataWriter<GV,DC>
 
 template <class GV, class DC>
 void VtkImageDataWriter<GV,DC>
-  ::writeParallelFile (std::ofstream& out, std::string const& pfilename, int /*size*/) const
+  ::writeParallelFile (std::ostream& out, std::string const& pfilename, int /*size*/) const
 {
   this->writeHeader(out, "PImageData");
 
@@ -38,25 +38,25 @@ namespace Dune
 
   private:
     /// Write a serial VTK file in Unstructured format
-    virtual void writeSerialFile (std::ofstream& out) const override;
+    virtual void writeSerialFile (std::ostream& out) const override;
 
     /// Write a parallel VTK file `pfilename.pvtu` in Unstructured format,
     /// with `size` the number of pieces and serial files given by `pfilename_p[i].vtu`
     /// for [i] in [0,...,size).
-    virtual void writeParallelFile (std::ofstream& out, std::string const& pfilename, int size) const override;
+    virtual void writeParallelFile (std::ostream& out, std::string const& pfilename, int size) const override;
 
-    void writeCoordinates (std::ofstream& out, std::vector<pos_type>& offsets,
+    void writeCoordinates (std::ostream& out, std::vector<pos_type>& offsets,
                            Std::optional<std::size_t> timestep = {}) const;
 
     template <class T>
-    std::array<std::uint64_t, 3> writeCoordinatesAppended (std::ofstream& out) const;
+    std::array<std::uint64_t, 3> writeCoordinatesAppended (std::ostream& out) const;
 
     virtual std::string fileExtension () const override
     {
       return "vtr";
     }
 
-    virtual void writeGridAppended (std::ofstream& out, std::vector<std::uint64_t>& blocks) const override;
+    virtual void writeGridAppended (std::ostream& out, std::vector<std::uint64_t>& blocks) const override;
 
   private:
     using Super::dataCollector_;
@@ -18,7 +18,7 @@ namespace Dune {
 
 template <class GV, class DC>
 void VtkRectilinearGridWriter<GV,DC>
-  ::writeSerialFile (std::ofstream& out) const
+  ::writeSerialFile (std::ostream& out) const
 {
   std::vector<pos_type> offsets; // pos => offset
   this->writeHeader(out, "RectilinearGrid");
@@ -59,7 +59,7 @@ void VtkRectilinearGridWriter<GV,DC>
 
 template <class GV, class DC>
 void VtkRectilinearGridWriter<GV,DC>
-  ::writeParallelFile (std::ofstream& out, std::string const& pfilename, int /*size*/) const
+  ::writeParallelFile (std::ostream& out, std::string const& pfilename, int /*size*/) const
 {
   this->writeHeader(out, "PRectilinearGrid");
 
@@ -115,7 +115,7 @@ void VtkRectilinearGridWriter<GV,DC>
 
 template <class GV, class DC>
 void VtkRectilinearGridWriter<GV,DC>
-  ::writeCoordinates (std::ofstream& out, std::vector<pos_type>& offsets,
+  ::writeCoordinates (std::ostream& out, std::vector<pos_type>& offsets,
                       Std::optional<std::size_t> timestep) const
 {
   std::string names = "xyz";
@@ -146,7 +146,7 @@ void VtkRectilinearGridWriter<GV,DC>
 
 template <class GV, class DC>
 void VtkRectilinearGridWriter<GV,DC>
-  ::writeGridAppended (std::ofstream& out, std::vector<std::uint64_t>& blocks) const
+  ::writeGridAppended (std::ostream& out, std::vector<std::uint64_t>& blocks) const
 {
   assert(is_a(format_, Vtk::APPENDED) && "Function should by called only in appended mode!\n");
 
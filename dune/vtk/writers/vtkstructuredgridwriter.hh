@@ -38,19 +38,19 @@ namespace Dune
 
   private:
     /// Write a serial VTK file in Unstructured format
-    virtual void writeSerialFile (std::ofstream& out) const override;
+    virtual void writeSerialFile (std::ostream& out) const override;
 
     /// Write a parallel VTK file `pfilename.pvtu` in Unstructured format,
     /// with `size` the number of pieces and serial files given by `pfilename_p[i].vtu`
     /// for [i] in [0,...,size).
-    virtual void writeParallelFile (std::ofstream& out, std::string const& pfilename, int size) const override;
+    virtual void writeParallelFile (std::ostream& out, std::string const& pfilename, int size) const override;
 
     virtual std::string fileExtension () const override
     {
       return "vts";
     }
 
-    virtual void writeGridAppended (std::ofstream& out, std::vector<std::uint64_t>& blocks) const override;
+    virtual void writeGridAppended (std::ostream& out, std::vector<std::uint64_t>& blocks) const override;
 
   private:
     using Super::dataCollector_;
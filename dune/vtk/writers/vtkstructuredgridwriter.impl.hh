@@ -18,7 +18,7 @@ namespace Dune {
 
 template <class GV, class DC>
 void VtkStructuredGridWriter<GV,DC>
-  ::writeSerialFile (std::ofstream& out) const
+  ::writeSerialFile (std::ostream& out) const
 {
   std::vector<pos_type> offsets; // pos => offset
   this->writeHeader(out, "StructuredGrid");
@@ -57,7 +57,7 @@ void VtkStructuredGridWriter<GV,DC>
 
 template <class GV, class DC>
 void VtkStructuredGridWriter<GV,DC>
-  ::writeParallelFile (std::ofstream& out, std::string const& pfilename, int /*size*/) const
+  ::writeParallelFile (std::ostream& out, std::string const& pfilename, int /*size*/) const
 {
   this->writeHeader(out, "PStructuredGrid");
 
@@ -114,14 +114,17 @@ void VtkStructuredGridWriter<GV,DC>
 
 template <class GV, class DC>
 void VtkStructuredGridWriter<GV,DC>
-  ::writeGridAppended (std::ofstream& out, std::vector<std::uint64_t>& blocks) const
+  ::writeGridAppended (std::ostream& out, std::vector<std::uint64_t>& blocks) const
 {
   assert(is_a(format_, Vtk::APPENDED) && "Function should by called only in appended mode!\n");
 
   // write points
-  blocks.push_back( datatype_ == Vtk::FLOAT32
-    ? this->writeValuesAppended(out, dataCollector_.template points<float>())
-    : this->writeValuesAppended(out, dataCollector_.template points<double>()) );
+  auto writePoints = [&](auto t) {
+    using T = decltype(t);
+    return this->template writeValuesAppended<T>(out, 3*dataCollector_.numPoints(),
+      [&](auto&& sink) { dataCollector_.template pointsChunked<T>(sink, this->template chunkSize<T>()); });
+  };
+  blocks.push_back(datatype_ == Vtk::FLOAT32 ? writePoints(float{}) : writePoints(double{}));
 }
 
 } // end namespace Dune
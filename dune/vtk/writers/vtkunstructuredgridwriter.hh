@@ -9,6 +9,7 @@
 #include <dune/vtk/vtkfunction.hh>
 #include <dune/vtk/vtktypes.hh>
 #include <dune/vtk/datacollectors/continuousdatacollector.hh>
+#include <dune/vtk/utility/aggregatedpiece.hh>
 
 #include <dune/vtk/vtkwriterinterface.hh>
 
@@ -38,14 +39,88 @@ namespace Dune
       : Super(gridView, format, datatype)
     {}
 
+    /// Value of \ref setNumAggregators for one aggregator rank per shared-memory node
+    static constexpr int aggregatePerNode = -1;
+
+    /// \brief Gather the partitions on a number of aggregator ranks that write merged pieces
+    /**
+     * In parallel, \ref write sends the collected points, cells and data of each rank to
+     * an aggregator rank. Each aggregator merges the partitions of its group into one
+     * piece and writes it to a file; the parallel .pvtu file lists only the merged pieces.
+     * The groups are formed by consecutive ranks, or by the ranks of a shared-memory node
+     * if `numAggregators` is \ref aggregatePerNode. A value of 0 disables the aggregation,
+     * i.e., each rank writes its own piece.
+     *
+     * The merged pieces are written like the pieces of single ranks, so the aggregation
+     * can be combined with \ref writeAsync, \ref setSequential and \ref setMeshCaching.
+     * With a valid mesh cache, only the point-data and cell-data is sent to the aggregators.
+     * \ref writeCollective does not aggregate the partitions.
+     *
+     * NOTE: Points on the partition boundary are duplicated in the merged piece.
+     **/
+    VtkUnstructuredGridWriter& setNumAggregators (int numAggregators)
+    {
+      numAggregators_ = numAggregators;
+      return *this;
+    }
+
+    using Super::write;
+
+    /// \brief Write the attached data to the file, \see VtkWriterInterface::write
+    virtual void write (std::string const& fn, Std::optional<std::string> dir = {}) const override;
+
+    /// \brief Write the attached data to the file in the background, \see VtkWriterInterface::writeAsync
+    virtual std::future<void> writeAsync (std::string const& fn, Std::optional<std::string> dir = {}) const override;
+
+    /// \brief Write the data of all ranks collectively into the single file `fn` using MPI-IO
+    /**
+     * Instead of one file per rank and a parallel .pvtu file, a single .vtu file is written
+     * that contains the partition of each rank as a separate `<Piece>`. The byte range of
+     * each rank in the file is computed by prefix sums over the sizes of the pieces, so all
+     * ranks write in parallel. Without MPI, this is equivalent to \ref write.
+     *
+     * \param fn  Filename of the VTK file. May contain a directory and any file extension.
+     **/
+    void writeCollective (std::string const& fn) const;
+
   private:
     /// Write a serial VTK file in Unstructured format
-    virtual void writeSerialFile (std::ofstream& out) const override;
+    virtual void writeSerialFile (std::ostream& out) const override;
 
     /// Write a parallel VTK file `pfilename.pvtu` in Unstructured format,
     /// with `size` the number of pieces and serial files given by `pfilename_p[i].vtu`
     /// for [i] in [0,...,size).
-    virtual void writeParallelFile (std::ofstream& out, std::string const& pfilename, int size) const override;
+    virtual void writeParallelFile (std::ostream& out, std::string const& pfilename, int size) const override;
+
+    // Gather the partitions on the aggregator ranks and write the merged pieces
+    void writeAggregated (std::string const& fn, Std::optional<std::string> dir) const;
+
+    // Gather the partitions on the aggregator ranks. Return the merged piece on the
+    // aggregators and nothing on the other ranks. The index of the merged piece of the
+    // group and the number of merged pieces are stored in `pieceIndex` and `numPieces`.
+    Std::optional<Vtk::AggregatedPiece> aggregate (int& pieceIndex, int& numPieces) const;
+
+    // Collect the raw arrays of this partition, see \ref Vtk::AggregatedPiece. If
+    // `withGrid` is false, the grid arrays are left empty.
+    Vtk::AggregatedPiece collectPiece (bool withGrid = true) const;
+
+    // Write the array `i` of the aggregated piece \ref piece_ with values of `type` in ascii format
+    void writePieceArrayAscii (std::ostream& out, Vtk::DataTypes type, std::size_t i) const;
+
+    // Return the type of the values of the coordinates or data of `type` stored in an aggregated
+    // piece. In ascii format, the values are stored in double precision, as written by \ref writeData.
+    Vtk::DataTypes pieceType (Vtk::DataTypes type) const
+    {
+      return format_ == Vtk::ASCII ? Vtk::FLOAT64 : type;
+    }
+
+    // Clear the mesh cache if the number of aggregators has changed since the last write,
+    // since the cached grid arrays belong to a merged piece of the previous aggregation
+    void updateAggregation (int numAggregators) const;
+
+    // Write the `<Piece>` element of this partition. In case of binary format, append
+    // the streampos of XML attributes "offset" to the vector `offsets`.
+    void writePiece (std::ostream& out, std::vector<pos_type>& offsets) const;
 
     /// Write a series of timesteps in one file
     /**
@@ -56,13 +131,19 @@ namespace Dune
      * \param blocks        A list of block sizes of the binary data stored in the files.
      *                      Order: (points, cells, pointdata[0], celldata[0], pointdata[1], celldata[1],...)
      **/
-    void writeTimeseriesSerialFile (std::ofstream& out,
+    void writeTimeseriesSerialFile (std::ostream& out,
                                     std::string const& filenameMesh,
                                     std::vector<std::pair<double, std::string>> const& timesteps,
                                     std::vector<std::uint64_t> const& blocks) const;
 
+    // Write the XML part of the timeseries file with placeholders for the offsets of
+    // the appended data. The positions of the placeholders are stored in `offsets`.
+    void writeTimeseriesHead (std::ostream& out,
+                              std::vector<std::vector<pos_type>>& offsets,
+                              std::vector<std::pair<double, std::string>> const& timesteps) const;
+
     /// Write parallel VTK file for series of timesteps
-    void writeTimeseriesParallelFile (std::ofstream& out,
+    void writeTimeseriesParallelFile (std::ostream& out,
                                       std::string const& pfilename, int size,
                                       std::vector<std::pair<double, std::string>> const& timesteps) const;
 
@@ -71,16 +152,16 @@ namespace Dune
       return "vtu";
     }
 
-    virtual void writeGridAppended (std::ofstream& out, std::vector<std::uint64_t>& blocks) const override;
+    virtual void writeGridAppended (std::ostream& out, std::vector<std::uint64_t>& blocks) const override;
 
     // Write the element connectivity to the output stream `out`. In case
     // of binary format, stores the streampos of XML attributes "offset" in the
     // vector `offsets`.
-    void writeCells (std::ofstream& out,
+    void writeCells (std::ostream& out,
                      std::vector<pos_type>& offsets,
                      Std::optional<std::size_t> timestep = {}) const;
 
-    void writePointIds (std::ofstream& out,
+    void writePointIds (std::ostream& out,
                         std::vector<pos_type>& offsets,
                         Std::optional<std::size_t> timestep = {}) const;
 
@@ -92,6 +173,8 @@ namespace Dune
     // attached data
     using Super::pointData_;
     using Super::cellData_;
+    int numAggregators_ = 0;
+    mutable int cachedAggregators_ = 0; // number of aggregators of the mesh cache
   };
 
 } // end namespace Dune
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
@@ -7,6 +9,11 @@
 #include <sstream>
 #include <string>
 
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <dune/common/exceptions.hh>
 #include <dune/geometry/referenceelements.hh>
 #include <dune/geometry/type.hh>
 
@@ -16,22 +23,152 @@
 
 namespace Dune {
 
+#if HAVE_MPI
+namespace Impl {
+
+// Write `data` collectively at position `pos` of the file `fh`. Large data is split
+// into several calls, since the count argument of MPI_File_write_at_all is an int.
+inline void writeAtAll (MPI_File fh, std::uint64_t pos, std::string const& data, MPI_Comm comm)
+{
+  const std::uint64_t max_count = 1u << 30;
+  std::uint64_t num_calls = (data.size() + max_count - 1) / max_count;
+  MPI_Allreduce(MPI_IN_PLACE, &num_calls, 1, MPI_UINT64_T, MPI_MAX, comm);
+
+  std::uint64_t written = 0;
+  for (std::uint64_t i = 0; i < num_calls; ++i) {
+    std::uint64_t count = std::min<std::uint64_t>(max_count, data.size() - written);
+    MPI_File_write_at_all(fh, MPI_Offset(pos + written), const_cast<char*>(data.data() + written),
+                          int(count), MPI_CHAR, MPI_STATUS_IGNORE);
+    written += count;
+  }
+}
+
+// Send the `bytes` to rank `dest` of the communicator `comm`
+inline void sendBytes (std::vector<unsigned char> const& bytes, int dest, MPI_Comm comm)
+{
+  const std::uint64_t max_count = 1u << 30;
+  std::uint64_t size = bytes.size();
+  MPI_Send(&size, 1, MPI_UINT64_T, dest, 0, comm);
+  for (std::uint64_t i = 0; i < size; i += max_count)
+    MPI_Send(const_cast<unsigned char*>(bytes.data() + i), int(std::min(max_count, size - i)),
+             MPI_BYTE, dest, 0, comm);
+}
+
+// Receive bytes sent by \ref sendBytes from rank `source` of the communicator `comm`
+inline std::vector<unsigned char> recvBytes (int source, MPI_Comm comm)
+{
+  const std::uint64_t max_count = 1u << 30;
+  std::uint64_t size = 0;
+  MPI_Recv(&size, 1, MPI_UINT64_T, source, 0, comm, MPI_STATUS_IGNORE);
+  std::vector<unsigned char> bytes(size);
+  for (std::uint64_t i = 0; i < size; i += max_count)
+    MPI_Recv(bytes.data() + i, int(std::min(max_count, size - i)),
+             MPI_BYTE, source, 0, comm, MPI_STATUS_IGNORE);
+  return bytes;
+}
+
+} // end namespace Impl
+#endif
+
+namespace Impl {
+
+template <class T>
+std::vector<T> fromBytes (std::vector<unsigned char> const& bytes)
+{
+  std::vector<T> values(bytes.size() / sizeof(T));
+  std::memcpy(values.data(), bytes.data(), values.size()*sizeof(T));
+  return values;
+}
+
+} // end namespace Impl
+
+
 template <class GV, class DC>
 void VtkUnstructuredGridWriter<GV,DC>
-  ::writeSerialFile (std::ofstream& out) const
+  ::write (std::string const& fn, Std::optional<std::string> dir) const
+{
+  if (numAggregators_ != 0 && this->comm().size() > 1)
+    writeAggregated(fn, dir);
+  else {
+    updateAggregation(0);
+    Super::write(fn, dir);
+  }
+}
+
+
+template <class GV, class DC>
+std::future<void> VtkUnstructuredGridWriter<GV,DC>
+  ::writeAsync (std::string const& fn, Std::optional<std::string> dir) const
+{
+  if (numAggregators_ == 0 || this->comm().size() == 1) {
+    updateAggregation(0);
+    return Super::writeAsync(fn, dir);
+  }
+
+  updateAggregation(numAggregators_);
+  this->updateDataCollector();
+  auto fns = this->filenames(fn, dir);
+
+  int pieceIndex = 0, numPieces = 0;
+  auto piece = aggregate(pieceIndex, numPieces);
+
+  // only the aggregators write a serial file
+  std::shared_ptr<typename Super::DeferredFile> file = nullptr;
+  if (piece) {
+    this->piece_ = &*piece;
+    try {
+      file = this->collectDeferredFile();
+    } catch (...) {
+      this->piece_ = nullptr;
+      throw;
+    }
+    this->piece_ = nullptr;
+  }
+
+  std::shared_ptr<std::string> parallel = nullptr;
+  if (this->comm().rank() == 0)
+    parallel = std::make_shared<std::string>(this->parallelFileString(fns[2], numPieces));
+
+  return this->submitFiles(fns[0] + "_p" + std::to_string(pieceIndex) + "." + this->fileExtension(), file,
+                           fns[1] + ".p" + this->fileExtension(), parallel);
+}
+
+
+template <class GV, class DC>
+void VtkUnstructuredGridWriter<GV,DC>
+  ::writeSerialFile (std::ostream& out) const
 {
   std::vector<pos_type> offsets; // pos => offset
   this->writeHeader(out, "UnstructuredGrid");
   out << "<UnstructuredGrid>\n";
 
+  writePiece(out, offsets);
+  out << "</UnstructuredGrid>\n";
+
+  this->writeAppended(out, offsets);
+  out << "</VTKFile>";
+}
+
+
+template <class GV, class DC>
+void VtkUnstructuredGridWriter<GV,DC>
+  ::writePiece (std::ostream& out, std::vector<pos_type>& offsets) const
+{
+  auto const* piece = this->piece_;
   out << "<Piece"
-      << " NumberOfPoints=\"" << dataCollector_.numPoints() << "\""
-      << " NumberOfCells=\"" << dataCollector_.numCells() << "\""
+      << " NumberOfPoints=\"" << (piece ? piece->numPoints : std::uint64_t(dataCollector_.numPoints())) << "\""
+      << " NumberOfCells=\"" << (piece ? piece->numCells : std::uint64_t(dataCollector_.numCells())) << "\""
       << ">\n";
 
   // Write point coordinates
   out << "<Points>\n";
-  this->writePoints(out, offsets);
+  if (piece)
+    this->writeDataArray(out, offsets, this->pointsAttributes(), {}, [&]
+    {
+      writePieceArrayAscii(out, pieceType(datatype_), Vtk::AggregatedPiece::POINTS);
+    });
+  else
+    this->writePoints(out, offsets);
   out << "</Points>\n";
 
   // Write element connectivity, types and offsets
@@ -40,29 +177,330 @@ void VtkUnstructuredGridWriter<GV,DC>
   writePointIds(out, offsets);
   out << "</Cells>\n";
 
-  // Write data associated with grid points
+  // Write data associated with grid points and grid cells. The arrays of an aggregated
+  // piece are stored in the same order after the grid arrays.
+  std::size_t i = Vtk::AggregatedPiece::NUM_GRID_ARRAYS;
+  auto writeData = [&](auto const& v, auto type)
+  {
+    if (piece)
+      this->writeDataArray(out, offsets, this->dataAttributes(v), {}, [&]
+      {
+        writePieceArrayAscii(out, pieceType(v.type()), i);
+      });
+    else
+      this->writeData(out, offsets, v, type);
+    ++i;
+  };
+
   out << "<PointData" << this->getNames(pointData_) << ">\n";
   for (auto const& v : pointData_)
-    this->writeData(out, offsets, v, Super::POINT_DATA);
+    writeData(v, Super::POINT_DATA);
   out << "</PointData>\n";
 
-  // Write data associated with grid cells
   out << "<CellData" << this->getNames(cellData_) << ">\n";
   for (auto const& v : cellData_)
-    this->writeData(out, offsets, v, Super::CELL_DATA);
+    writeData(v, Super::CELL_DATA);
   out << "</CellData>\n";
 
   out << "</Piece>\n";
-  out << "</UnstructuredGrid>\n";
+}
 
-  this->writeAppended(out, offsets);
-  out << "</VTKFile>";
+
+template <class GV, class DC>
+void VtkUnstructuredGridWriter<GV,DC>
+  ::writeAggregated (std::string const& fn, Std::optional<std::string> dir) const
+{
+  updateAggregation(numAggregators_);
+  this->updateDataCollector();
+  auto fns = this->filenames(fn, dir);
+
+  int pieceIndex = 0, numPieces = 0;
+  auto piece = aggregate(pieceIndex, numPieces);
+
+  if (piece) {
+    std::string serial_fn = fns[0] + "_p" + std::to_string(pieceIndex) + "." + this->fileExtension();
+    std::ofstream serial_out(serial_fn, std::ios_base::ate | std::ios::binary);
+    if (!serial_out.is_open())
+      DUNE_THROW(IOError, "Could not open file " << serial_fn << " for writing.");
+
+    serial_out.imbue(std::locale::classic());
+    serial_out << std::setprecision(datatype_ == Vtk::FLOAT32
+      ? std::numeric_limits<float>::digits10+2
+      : std::numeric_limits<double>::digits10+2);
+
+    // the merged piece is written instead of the partition of this rank
+    this->piece_ = &*piece;
+    try {
+      if (this->sequential_)
+        this->writeSerialFileSequential(serial_out);
+      else
+        writeSerialFile(serial_out);
+    } catch (...) {
+      this->piece_ = nullptr;
+      throw;
+    }
+    this->piece_ = nullptr;
+  }
+
+  if (this->comm().rank() == 0) {
+    // write parallel file
+    std::ofstream parallel_out(fns[1] + ".p" + this->fileExtension(), std::ios_base::ate | std::ios::binary);
+    assert(parallel_out.is_open());
+
+    parallel_out.imbue(std::locale::classic());
+    parallel_out << std::setprecision(datatype_ == Vtk::FLOAT32
+      ? std::numeric_limits<float>::digits10+2
+      : std::numeric_limits<double>::digits10+2);
+
+    writeParallelFile(parallel_out, fns[2], numPieces);
+  }
+}
+
+
+template <class GV, class DC>
+Std::optional<Vtk::AggregatedPiece> VtkUnstructuredGridWriter<GV,DC>
+  ::aggregate (int& pieceIndex, int& numPieces) const
+{
+#if HAVE_MPI
+  MPI_Comm comm = this->comm();
+  int rank = this->comm().rank();
+  int size = this->comm().size();
+
+  // split the ranks into groups with one aggregator each
+  MPI_Comm group;
+  if (numAggregators_ == aggregatePerNode)
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &group);
+  else {
+    std::int64_t n = std::min(std::max(numAggregators_, 1), size);
+    MPI_Comm_split(comm, int(rank * n / size), rank, &group);
+  }
+
+  int groupRank = 0, groupSize = 1;
+  MPI_Comm_rank(group, &groupRank);
+  MPI_Comm_size(group, &groupSize);
+
+  // the aggregators are numbered in the order of their ranks
+  int isAggregator = groupRank == 0 ? 1 : 0;
+  pieceIndex = 0;
+  numPieces = 0;
+  MPI_Exscan(&isAggregator, &pieceIndex, 1, MPI_INT, MPI_SUM, comm);
+  MPI_Allreduce(&isAggregator, &numPieces, 1, MPI_INT, MPI_SUM, comm);
+  if (rank == 0)
+    pieceIndex = 0;
+
+  // the grid is not sent if the aggregator reuses the cached grid arrays of the merged piece
+  int withGrid = is_a(format_, Vtk::APPENDED) && this->meshCache_.enabled && !this->meshCache_.blocks.empty() ? 0 : 1;
+  MPI_Bcast(&withGrid, 1, MPI_INT, 0, group);
+
+  Std::optional<Vtk::AggregatedPiece> piece;
+  if (isAggregator) {
+    piece = collectPiece(withGrid == 1);
+    for (int r = 1; r < groupSize; ++r)
+      piece->merge(Vtk::AggregatedPiece::deserialize(Impl::recvBytes(r, group)));
+  } else {
+    Impl::sendBytes(collectPiece(withGrid == 1).serialize(), 0, group);
+  }
+  MPI_Comm_free(&group);
+  return piece;
+#else
+  pieceIndex = 0;
+  numPieces = 1;
+  return collectPiece();
+#endif
+}
+
+
+template <class GV, class DC>
+Vtk::AggregatedPiece VtkUnstructuredGridWriter<GV,DC>
+  ::collectPiece (bool withGrid) const
+{
+  Vtk::AggregatedPiece piece;
+  piece.numPoints = dataCollector_.numPoints();
+  piece.numCells = dataCollector_.numCells();
+
+  auto const& ids = this->pointIds();
+  if (withGrid) {
+    if (pieceType(datatype_) == Vtk::FLOAT32)
+      piece.push_back(dataCollector_.template points<float>());
+    else
+      piece.push_back(dataCollector_.template points<double>());
+
+    auto const& cells = dataCollector_.cells();
+    piece.push_back(cells.connectivity);
+    piece.push_back(cells.offsets);
+    piece.push_back(cells.types);
+    piece.push_back(ids);
+  } else {
+    piece.arrays.resize(Vtk::AggregatedPiece::NUM_GRID_ARRAYS);
+  }
+
+  if (this->fusedCollection_) {
+    auto pushValues = [&](auto const& v, std::vector<double> const& values) {
+      if (pieceType(v.type()) == Vtk::FLOAT32)
+        piece.push_back(std::vector<float>(values.begin(), values.end()));
+      else
+        piece.push_back(values);
+    };
+
+    auto pointValues = dataCollector_.template pointDataFused<double>(pointData_);
+    auto cellValues = dataCollector_.template cellDataFused<double>(cellData_);
+    for (std::size_t i = 0; i < pointData_.size(); ++i)
+      pushValues(pointData_[i], pointValues[i]);
+    for (std::size_t i = 0; i < cellData_.size(); ++i)
+      pushValues(cellData_[i], cellValues[i]);
+    return piece;
+  }
+
+  for (auto const& v : pointData_) {
+    if (pieceType(v.type()) == Vtk::FLOAT32)
+      piece.push_back(dataCollector_.template pointData<float>(v));
+    else
+      piece.push_back(dataCollector_.template pointData<double>(v));
+  }
+  for (auto const& v : cellData_) {
+    if (pieceType(v.type()) == Vtk::FLOAT32)
+      piece.push_back(dataCollector_.template cellData<float>(v));
+    else
+      piece.push_back(dataCollector_.template cellData<double>(v));
+  }
+  return piece;
+}
+
+
+template <class GV, class DC>
+void VtkUnstructuredGridWriter<GV,DC>
+  ::writePieceArrayAscii (std::ostream& out, Vtk::DataTypes type, std::size_t i) const
+{
+  auto const& bytes = this->piece_->arrays[i];
+  switch (type) {
+    case Vtk::UINT8:   this->writeValuesAscii(out, Impl::fromBytes<std::uint8_t>(bytes));  break;
+    case Vtk::INT64:   this->writeValuesAscii(out, Impl::fromBytes<std::int64_t>(bytes));  break;
+    case Vtk::UINT64:  this->writeValuesAscii(out, Impl::fromBytes<std::uint64_t>(bytes)); break;
+    case Vtk::FLOAT32: this->writeValuesAscii(out, Impl::fromBytes<float>(bytes));         break;
+    case Vtk::FLOAT64: this->writeValuesAscii(out, Impl::fromBytes<double>(bytes));        break;
+    default:
+      DUNE_THROW(Dune::NotImplemented, "Unsupported datatype " << to_string(type) << " of aggregated array.");
+  }
+}
+
+
+template <class GV, class DC>
+void VtkUnstructuredGridWriter<GV,DC>
+  ::updateAggregation (int numAggregators) const
+{
+  if (numAggregators != cachedAggregators_) {
+    this->meshCache_.valid = false;
+    this->meshCache_.clear();
+    cachedAggregators_ = numAggregators;
+  }
+}
+
+
+template <class GV, class DC>
+void VtkUnstructuredGridWriter<GV,DC>
+  ::writeCollective (std::string const& fn) const
+{
+  auto p = filesystem::path(fn);
+  auto name = p.stem();
+  p.remove_filename();
+  p /= name.string();
+
+#if HAVE_MPI
+  MPI_Comm comm = this->comm();
+  if (this->comm().size() == 1) {
+    this->write(fn);
+    return;
+  }
+
+  updateAggregation(0);
+  this->updateDataCollector();
+
+  // Collect the piece of this rank with offsets relative to its appended data
+  typename Super::DeferredFile file;
+  {
+    std::stringstream piece(std::ios::in | std::ios::out | std::ios::binary);
+    piece.imbue(std::locale::classic());
+    piece << std::setprecision(datatype_ == Vtk::FLOAT32
+      ? std::numeric_limits<float>::digits10+2
+      : std::numeric_limits<double>::digits10+2);
+
+    std::vector<pos_type> offsets;
+    std::ostringstream tags;
+    this->deferred_ = &file;
+    try {
+      writePiece(piece, offsets);
+      this->writeAppended(tags, offsets);
+    } catch (...) {
+      this->deferred_ = nullptr;
+      throw;
+    }
+    this->deferred_ = nullptr;
+    file.head = piece.str();
+  }
+
+  std::vector<std::uint64_t> blocks;
+  std::string appended = is_a(format_, Vtk::APPENDED)
+    ? Super::encodeDeferredArrays(file, blocks, format_, this->block_size,
+                                  this->compression_level, this->threadPool())
+    : std::string{};
+
+  // The file is [prefix][pieces][middle][appended data][suffix]
+  std::string prefix, middle, suffix;
+  {
+    std::ostringstream out(std::ios::binary);
+    this->writeHeader(out, "UnstructuredGrid");
+    out << "<UnstructuredGrid>\n";
+    prefix = out.str();
+
+    middle = "</UnstructuredGrid>\n";
+    if (is_a(format_, Vtk::APPENDED)) {
+      middle += "<AppendedData encoding=\"raw\">\n_";
+      suffix = "</AppendedData>\n";
+    }
+    suffix += "</VTKFile>";
+  }
+
+  // The byte ranges of the ranks are given by prefix sums over the piece sizes
+  std::uint64_t sizes[2] = {std::uint64_t(file.head.size()), std::uint64_t(appended.size())};
+  std::uint64_t starts[2] = {0, 0};
+  std::uint64_t totals[2] = {0, 0};
+  MPI_Exscan(sizes, starts, 2, MPI_UINT64_T, MPI_SUM, comm);
+  MPI_Allreduce(sizes, totals, 2, MPI_UINT64_T, MPI_SUM, comm);
+  if (this->comm().rank() == 0)
+    starts[0] = starts[1] = 0;
+
+  Super::fillOffsets(file.head, file.offsets, blocks, starts[1]);
+
+  std::uint64_t piece_pos = prefix.size() + starts[0];
+  std::uint64_t middle_pos = prefix.size() + totals[0];
+  std::uint64_t appended_pos = middle_pos + middle.size() + starts[1];
+  std::uint64_t suffix_pos = middle_pos + middle.size() + totals[1];
+
+  std::string filename = p.string() + "." + this->fileExtension();
+  MPI_File fh;
+  int ec = MPI_File_open(comm, const_cast<char*>(filename.c_str()),
+                         MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh);
+  if (ec != MPI_SUCCESS)
+    DUNE_THROW(IOError, "Could not open file " << filename << " for collective writing.");
+  MPI_File_set_size(fh, MPI_Offset(suffix_pos + suffix.size()));
+
+  Impl::writeAtAll(fh, piece_pos, file.head, comm);
+  Impl::writeAtAll(fh, appended_pos, appended, comm);
+  if (this->comm().rank() == 0) {
+    MPI_File_write_at(fh, 0, const_cast<char*>(prefix.data()), int(prefix.size()), MPI_CHAR, MPI_STATUS_IGNORE);
+    MPI_File_write_at(fh, MPI_Offset(middle_pos), const_cast<char*>(middle.data()), int(middle.size()), MPI_CHAR, MPI_STATUS_IGNORE);
+    MPI_File_write_at(fh, MPI_Offset(suffix_pos), const_cast<char*>(suffix.data()), int(suffix.size()), MPI_CHAR, MPI_STATUS_IGNORE);
+  }
+  MPI_File_close(&fh);
+#else
+  this->write(fn);
+#endif
 }
 
 
 template <class GV, class DC>
 void VtkUnstructuredGridWriter<GV,DC>
-  ::writeParallelFile (std::ofstream& out, std::string const& pfilename, int size) const
+  ::writeParallelFile (std::ostream& out, std::string const& pfilename, int size) const
 {
   this->writeHeader(out, "PUnstructuredGrid");
   out << "<PUnstructuredGrid GhostLevel=\"0\">\n";
@@ -110,14 +548,73 @@ void VtkUnstructuredGridWriter<GV,DC>
 
 template <class GV, class DC>
 void VtkUnstructuredGridWriter<GV,DC>
-  ::writeTimeseriesSerialFile (std::ofstream& out,
+  ::writeTimeseriesSerialFile (std::ostream& out,
                                std::string const& filenameMesh,
                                std::vector<std::pair<double, std::string>> const& timesteps,
                                std::vector<std::uint64_t> const& blocks) const
 {
   assert(is_a(format_, Vtk::APPENDED));
 
+  // The XML part is written to a buffer first and the offsets are filled in before
+  // anything is written to `out`. Thus, the file is written strictly front to back.
+  std::stringstream head(std::ios::in | std::ios::out | std::ios::binary);
+  head.imbue(out.getloc());
+  head.precision(out.precision());
+
   std::vector<std::vector<pos_type>> offsets(timesteps.size()); // pos => offset
+  writeTimeseriesHead(head, offsets, timesteps);
+  const std::size_t shift = offsets[0].size(); // number of blocks to write the grid
+
+  // write correct offsets in buffer.
+  pos_type offset = 0;
+  for (std::size_t i = 0; i < timesteps.size(); ++i) {
+    offset = 0;
+    auto const& off = offsets[i];
+
+    // write mesh data offsets
+    for (std::size_t j = 0; j < shift; ++j) {
+      head.seekp(off[j]);
+      head << '"' << offset << '"';
+      offset += pos_type(blocks[j]);
+    }
+  }
+
+  std::size_t j = shift;
+  for (std::size_t i = 0; i < timesteps.size(); ++i) {
+    auto const& off = offsets[i];
+
+    for (std::size_t k = shift; k < off.size(); ++k) {
+      head.seekp(off[k]);
+      head << '"' << offset << '"';
+      offset += pos_type(blocks[j++]);
+    }
+  }
+
+  out << head.rdbuf();
+  out << "<AppendedData encoding=\"raw\">\n_";
+
+  { // write grid (points, cells)
+    std::ifstream file_mesh(filenameMesh, std::ios_base::in | std::ios_base::binary);
+    out << file_mesh.rdbuf();
+  }
+
+  // write point-data and cell-data
+  for (auto const& timestep : timesteps) {
+    std::ifstream file(timestep.second, std::ios_base::in | std::ios_base::binary);
+    out << file.rdbuf();
+  }
+  out << "</AppendedData>\n";
+
+  out << "</VTKFile>";
+}
+
+
+template <class GV, class DC>
+void VtkUnstructuredGridWriter<GV,DC>
+  ::writeTimeseriesHead (std::ostream& out,
+                         std::vector<std::vector<pos_type>>& offsets,
+                         std::vector<std::pair<double, std::string>> const& timesteps) const
+{
   this->writeHeader(out, "UnstructuredGrid");
   out << "<UnstructuredGrid"
       << " TimeValues=\"";
@@ -148,8 +645,6 @@ void VtkUnstructuredGridWriter<GV,DC>
   }
   out << "</Cells>\n";
 
-  const std::size_t shift = offsets[0].size(); // number of blocks to write the grid
-
   // Write data associated with grid points
   out << "<PointData" << this->getNames(pointData_) << ">\n";
   for (std::size_t i = 0; i < timesteps.size(); ++i) {
@@ -168,55 +663,12 @@ void VtkUnstructuredGridWriter<GV,DC>
 
   out << "</Piece>\n";
   out << "</UnstructuredGrid>\n";
-
-  out << "<AppendedData encoding=\"raw\">\n_";
-  pos_type appended_pos = out.tellp();
-
-  { // write grid (points, cells)
-    std::ifstream file_mesh(filenameMesh, std::ios_base::in | std::ios_base::binary);
-    out << file_mesh.rdbuf();
-    assert( std::uint64_t(out.tellp()) == std::accumulate(blocks.begin(), std::next(blocks.begin(),shift), std::uint64_t(appended_pos)) );
-  }
-
-  // write point-data and cell-data
-  for (auto const& timestep : timesteps) {
-    std::ifstream file(timestep.second, std::ios_base::in | std::ios_base::binary);
-    out << file.rdbuf();
-  }
-  out << "</AppendedData>\n";
-
-  out << "</VTKFile>";
-
-  // write correct offsets in file.
-  pos_type offset = 0;
-  for (std::size_t i = 0; i < timesteps.size(); ++i) {
-    offset = 0;
-    auto const& off = offsets[i];
-
-    // write mesh data offsets
-    for (std::size_t j = 0; j < shift; ++j) {
-      out.seekp(off[j]);
-      out << '"' << offset << '"';
-      offset += pos_type(blocks[j]);
-    }
-  }
-
-  std::size_t j = shift;
-  for (std::size_t i = 0; i < timesteps.size(); ++i) {
-    auto const& off = offsets[i];
-
-    for (std::size_t k = shift; k < off.size(); ++k) {
-      out.seekp(off[k]);
-      out << '"' << offset << '"';
-      offset += pos_type(blocks[j++]);
-    }
-  }
 }
 
 
 template <class GV, class DC>
 void VtkUnstructuredGridWriter<GV,DC>
-  ::writeTimeseriesParallelFile (std::ofstream& out,
+  ::writeTimeseriesParallelFile (std::ostream& out,
                                  std::string const& pfilename,
                                  int size,
                                  std::vector<std::pair<double, std::string>> const& timesteps) const
@@ -280,106 +732,94 @@ void VtkUnstructuredGridWriter<GV,DC>
 
 template <class GV, class DC>
 void VtkUnstructuredGridWriter<GV,DC>
-  ::writeCells (std::ofstream& out, std::vector<pos_type>& offsets,
+  ::writeCells (std::ostream& out, std::vector<pos_type>& offsets,
                 Std::optional<std::size_t> timestep) const
 {
-  if (format_ == Vtk::ASCII) {
-    auto cells = dataCollector_.cells();
-    out << "<DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\"";
-    if (timestep)
-      out << " TimeStep=\"" << *timestep << "\"";
-    out << ">\n";
-    this->writeValuesAscii(out, cells.connectivity);
-    out << "</DataArray>\n";
-
-    out << "<DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\"";
-    if (timestep)
-      out << " TimeStep=\"" << *timestep << "\"";
-    out << ">\n";
-    this->writeValuesAscii(out, cells.offsets);
-    out << "</DataArray>\n";
-
-    out << "<DataArray type=\"UInt8\" Name=\"types\" format=\"ascii\"";
-    if (timestep)
-      out << " TimeStep=\"" << *timestep << "\"";
-    out << ">\n";
-    this->writeValuesAscii(out, cells.types);
-    out << "</DataArray>\n";
-  }
-  else { // Vtk::APPENDED format
-    out << "<DataArray type=\"Int64\" Name=\"connectivity\" format=\"appended\"";
-    if (timestep)
-      out << " TimeStep=\"" << *timestep << "\"";
-    out << " offset=";
-    offsets.push_back(out.tellp());
-    out << std::string(std::numeric_limits<std::uint64_t>::digits10 + 2, ' ');
-    out << "/>\n";
-
-    out << "<DataArray type=\"Int64\" Name=\"offsets\" format=\"appended\"";
-    if (timestep)
-      out << " TimeStep=\"" << *timestep << "\"";
-    out << " offset=";
-    offsets.push_back(out.tellp());
-    out << std::string(std::numeric_limits<std::uint64_t>::digits10 + 2, ' ');
-    out << "/>\n";
-
-    out << "<DataArray type=\"UInt8\" Name=\"types\" format=\"appended\"";
-    if (timestep)
-      out << " TimeStep=\"" << *timestep << "\"";
-    out << " offset=";
-    offsets.push_back(out.tellp());
-    out << std::string(std::numeric_limits<std::uint64_t>::digits10 + 2, ' ');
-    out << "/>\n";
+  using P = Vtk::AggregatedPiece;
+  if (format_ == Vtk::ASCII && !this->piece_) {
+    auto const& cells = dataCollector_.cells();
+    this->writeDataArray(out, offsets, " type=\"Int64\" Name=\"connectivity\"", timestep, [&]
+    {
+      this->writeValuesAscii(out, cells.connectivity);
+    });
+    this->writeDataArray(out, offsets, " type=\"Int64\" Name=\"offsets\"", timestep, [&]
+    {
+      this->writeValuesAscii(out, cells.offsets);
+    });
+    this->writeDataArray(out, offsets, " type=\"UInt8\" Name=\"types\"", timestep, [&]
+    {
+      this->writeValuesAscii(out, cells.types);
+    });
+  }
+  else { // Vtk::APPENDED format or aggregated piece
+    this->writeDataArray(out, offsets, " type=\"Int64\" Name=\"connectivity\"", timestep, [&]
+    {
+      writePieceArrayAscii(out, Vtk::INT64, P::CONNECTIVITY);
+    });
+    this->writeDataArray(out, offsets, " type=\"Int64\" Name=\"offsets\"", timestep, [&]
+    {
+      writePieceArrayAscii(out, Vtk::INT64, P::OFFSETS);
+    });
+    this->writeDataArray(out, offsets, " type=\"UInt8\" Name=\"types\"", timestep, [&]
+    {
+      writePieceArrayAscii(out, Vtk::UINT8, P::TYPES);
+    });
   }
 }
 
 template <class GV, class DC>
 void VtkUnstructuredGridWriter<GV,DC>
-  ::writePointIds (std::ofstream& out,
+  ::writePointIds (std::ostream& out,
                    std::vector<pos_type>& offsets,
                    Std::optional<std::size_t> timestep) const
 {
-  auto ids = dataCollector_.pointIds();
+  auto const& ids = this->pointIds();
   if (ids.empty())
     return;
 
-  if (format_ == Vtk::ASCII) {
-    out << "<DataArray type=\"UInt64\" Name=\"global_point_ids\" format=\"ascii\"";
-    if (timestep)
-      out << " TimeStep=\"" << *timestep << "\"";
-    out << ">\n";
-    this->writeValuesAscii(out, ids);
-    out << "</DataArray>\n";
-  }
-  else { // Vtk::APPENDED format
-    out << "<DataArray type=\"UInt64\" Name=\"global_point_ids\" format=\"appended\"";
-    if (timestep)
-      out << " TimeStep=\"" << *timestep << "\"";
-    out << " offset=";
-    offsets.push_back(out.tellp());
-    out << std::string(std::numeric_limits<std::uint64_t>::digits10 + 2, ' ');
-    out << "/>\n";
-  }
+  this->writeDataArray(out, offsets, " type=\"UInt64\" Name=\"global_point_ids\"", timestep, [&]
+  {
+    if (this->piece_)
+      writePieceArrayAscii(out, Vtk::UINT64, Vtk::AggregatedPiece::POINT_IDS);
+    else
+      this->writeValuesAscii(out, ids);
+  });
 }
 
 template <class GV, class DC>
 void VtkUnstructuredGridWriter<GV,DC>
-  ::writeGridAppended (std::ofstream& out, std::vector<std::uint64_t>& blocks) const
+  ::writeGridAppended (std::ostream& out, std::vector<std::uint64_t>& blocks) const
 {
   assert(is_a(format_, Vtk::APPENDED) && "Function should by called only in appended mode!\n");
 
+  if (this->piece_) {
+    // the grid arrays of the aggregated piece are collected already
+    using P = Vtk::AggregatedPiece;
+    assert(!this->piece_->arrays[P::TYPES].empty() || this->piece_->numCells == 0);
+    for (std::size_t i = 0; i < P::NUM_GRID_ARRAYS; ++i) {
+      if (i != P::POINT_IDS || !this->pointIds().empty())
+        blocks.push_back(this->writeValuesAppended(out, this->piece_->arrays[i]));
+    }
+    return;
+  }
+
   // write points
-  blocks.push_back( datatype_ == Vtk::FLOAT32
-    ? this->writeValuesAppended(out, dataCollector_.template points<float>())
-    : this->writeValuesAppended(out, dataCollector_.template points<double>()) );
+  auto writePoints = [&](auto t) {
+    using T = decltype(t);
+    return this->template writeValuesAppended<T>(out, 3*dataCollector_.numPoints(),
+      [&](auto&& sink) { dataCollector_.template pointsChunked<T>(sink, this->template chunkSize<T>()); });
+  };
+  blocks.push_back(datatype_ == Vtk::FLOAT32 ? writePoints(float{}) : writePoints(double{}));
 
   // write conncetivity, offsets, and types
-  auto cells = dataCollector_.cells();
-  blocks.push_back(this->writeValuesAppended(out, cells.connectivity));
-  blocks.push_back(this->writeValuesAppended(out, cells.offsets));
-  blocks.push_back(this->writeValuesAppended(out, cells.types));
-
-  auto ids = dataCollector_.pointIds();
+  blocks.push_back(this->template writeValuesAppended<std::int64_t>(out, dataCollector_.connectivitySize(),
+    [&](auto&& sink) { dataCollector_.connectivityChunked(sink, this->template chunkSize<std::int64_t>()); }));
+  blocks.push_back(this->template writeValuesAppended<std::int64_t>(out, dataCollector_.numCells(),
+    [&](auto&& sink) { dataCollector_.offsetsChunked(sink, this->template chunkSize<std::int64_t>()); }));
+  blocks.push_back(this->template writeValuesAppended<std::uint8_t>(out, dataCollector_.numCells(),
+    [&](auto&& sink) { dataCollector_.typesChunked(sink, this->template chunkSize<std::uint8_t>()); }));
+
+  auto const& ids = this->pointIds();
   if (!ids.empty())
     blocks.push_back(this->writeValuesAppended(out, ids));
 }
@@ -26,6 +26,8 @@
 #include <dune/vtk/datacollectors/continuousdatacollector.hh>
 #include <dune/vtk/datacollectors/discontinuousdatacollector.hh>
 #include <dune/vtk/datacollectors/quadraticdatacollector.hh>
+#include <dune/vtk/datacollectors/lagrangedatacollector.hh>
+#include <dune/vtk/datacollectors/subsamplingdatacollector.hh>
 
 using namespace Dune;
 using namespace Dune::Functions;
@@ -69,6 +71,8 @@ void write (std::string prefix, GridView const& gridView)
   write_dc<ContinuousDataCollector<GridView>>(prefix + "_continuous", gridView, p1Interpol, p1Analytic);
   write_dc<DiscontinuousDataCollector<GridView>>(prefix + "_discontinuous", gridView, p1Interpol, p1Analytic);
   write_dc<QuadraticDataCollector<GridView>>(prefix + "_quadratic", gridView, p1Interpol, p1Analytic);
+  write_dc<LagrangeDataCollector<GridView,3>>(prefix + "_lagrange3", gridView, p1Interpol, p1Analytic);
+  write_dc<SubsamplingDataCollector<GridView,2>>(prefix + "_subsampling2", gridView, p1Interpol, p1Analytic);
 }
 
 template <int I>
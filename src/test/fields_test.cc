@@ -0,0 +1,291 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/parallel/mpihelper.hh> // An initializer of MPI
+#include <dune/common/filledarray.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/test/testsuite.hh>
+#include <dune/common/version.hh>
+
+#include <dune/functions/functionspacebases/defaultglobalbasis.hh>
+#include <dune/functions/functionspacebases/lagrangebasis.hh>
+#include <dune/functions/functionspacebases/interpolate.hh>
+#include <dune/functions/gridfunctions/analyticgridviewfunction.hh>
+#include <dune/functions/gridfunctions/discreteglobalbasisfunction.hh>
+#include <dune/grid/uggrid.hh>
+#include <dune/grid/utility/structuredgridfactory.hh>
+
+#include <dune/vtk/discretevtkfunction.hh>
+#include <dune/vtk/vtkreader.hh>
+#include <dune/vtk/vtktypedwriter.hh>
+#include <dune/vtk/writers/vtkunstructuredgridwriter.hh>
+#include <dune/vtk/datacollectors/lagrangedatacollector.hh>
+#include <dune/vtk/gridcreators/continuousgridcreator.hh>
+
+using namespace Dune;
+
+// see https://stackoverflow.com/questions/6163611/compare-two-files
+bool compare_files (std::string const& fn1, std::string const& fn2)
+{
+  std::ifstream in1(fn1, std::ios::binary);
+  std::ifstream in2(fn2, std::ios::binary);
+  if (!in1 || !in2) {
+    std::cout << "can not find file " << fn1 << " or file " << fn2 << "\n";
+    return false;
+  }
+
+  std::ifstream::pos_type size1 = in1.seekg(0, std::ifstream::end).tellg();
+  in1.seekg(0, std::ifstream::beg);
+
+  std::ifstream::pos_type size2 = in2.seekg(0, std::ifstream::end).tellg();
+  in2.seekg(0, std::ifstream::beg);
+
+  if (size1 != size2)
+    return false;
+
+  static const std::size_t BLOCKSIZE = 4096;
+  std::size_t remaining = size1;
+
+  while (remaining) {
+    char buffer1[BLOCKSIZE], buffer2[BLOCKSIZE];
+    std::size_t size = std::min(BLOCKSIZE, remaining);
+
+    in1.read(buffer1, size);
+    in2.read(buffer2, size);
+
+    if (0 != std::memcmp(buffer1, buffer2, size))
+      return false;
+
+    remaining -= size;
+  }
+
+  return true;
+}
+
+// Read the point or cell data `name` of the .vtu file `filename`
+template <class Grid>
+std::vector<double> read_data (std::string const& filename, std::string const& name, bool pointData)
+{
+  GridFactory<Grid> factory;
+  VtkReader<Grid> reader{factory};
+  reader.readFromFile(filename, false);
+  return pointData ? reader.template pointData<double>(name) : reader.template cellData<double>(name);
+}
+
+// Compare the data `name` of two files up to rounding errors
+template <class Grid>
+bool compare_data (std::string const& fn1, std::string const& fn2, std::string const& name, bool pointData)
+{
+  auto data1 = read_data<Grid>(fn1, name, pointData);
+  auto data2 = read_data<Grid>(fn2, name, pointData);
+  if (data1.empty() || data1.size() != data2.size())
+    return false;
+
+  for (std::size_t i = 0; i < data1.size(); ++i)
+    if (std::abs(data1[i] - data2[i]) > 1.e-10 * (1.0 + std::abs(data1[i])))
+      return false;
+  return true;
+}
+
+// A grid function that provides only its local function, thus it is evaluated pointwise
+template <class GridFunction>
+struct LocalFunctionOnly
+{
+  GridFunction fct;
+
+  friend auto localFunction (LocalFunctionOnly const& f)
+  {
+    return localFunction(f.fct);
+  }
+};
+
+
+// Evaluate all fields in one traversal of the grid and field by field
+template <class DataCollector, class GridView>
+void fused_test (TestSuite& test, GridView const& gridView, std::string const& base_name)
+{
+  auto f = Functions::makeAnalyticGridViewFunction([](auto const& x) { return x[0] + 2*x[1]; }, gridView);
+  auto v = Functions::makeAnalyticGridViewFunction([](auto const& x) { return x; }, gridView);
+
+  for (auto format : {Vtk::BINARY, Vtk::COMPRESSED}) {
+    std::string name = base_name + (format == Vtk::BINARY ? "_bin" : "_zlib");
+    for (bool fused : {false, true}) {
+      VtkUnstructuredGridWriter<GridView, DataCollector> vtkWriter(gridView, format, Vtk::FLOAT64);
+      vtkWriter.addPointData(f, "p").addPointData(v, "v");
+      vtkWriter.addCellData(f, "c").addCellData(v, "w");
+      vtkWriter.setFusedCollection(fused);
+      vtkWriter.write(name + (fused ? "_fused.vtu" : "_unfused.vtu"));
+    }
+    test.check(compare_files(name + "_unfused.vtu", name + "_fused.vtu"), name + ": fused collection");
+  }
+}
+
+// Attach vertex and element values by their index instead of a grid function
+template <class Grid, class GridView>
+void indexed_test (TestSuite& test, GridView const& gridView, std::string const& base_name)
+{
+  auto fn = [](auto const& x) { return x[0] + 2*x[1]; };
+  auto f = Functions::makeAnalyticGridViewFunction(fn, gridView);
+  auto v = Functions::makeAnalyticGridViewFunction([](auto const& x) { return x; }, gridView);
+
+  using Vector = FieldVector<double,GridView::dimensionworld>;
+  auto const& indexSet = gridView.indexSet();
+  std::vector<double> vertexValues(indexSet.size(GridView::dimension));
+  std::vector<Vector> vertexVectors(vertexValues.size());
+  for (auto const& vertex : vertices(gridView)) {
+    auto x = vertex.geometry().corner(0);
+    vertexValues[indexSet.index(vertex)] = fn(x);
+    vertexVectors[indexSet.index(vertex)] = x;
+  }
+
+  std::vector<double> elementValues(indexSet.size(0));
+  for (auto const& element : elements(gridView))
+    elementValues[indexSet.index(element)] = fn(element.geometry().center());
+
+  {
+    VtkUnstructuredGridWriter<GridView> vtkWriter(gridView, Vtk::BINARY, Vtk::FLOAT64);
+    vtkWriter.addPointData(f, "p").addPointData(v, "v").addCellData(f, "c");
+    vtkWriter.write(base_name + "_function.vtu");
+  }
+  {
+    VtkUnstructuredGridWriter<GridView> vtkWriter(gridView, Vtk::BINARY, Vtk::FLOAT64);
+    vtkWriter.addPointData(vertexValues, "p").addPointData(vertexVectors, "v").addCellData(elementValues, "c");
+    vtkWriter.write(base_name + "_indexed.vtu");
+  }
+
+  std::string fn1 = base_name + "_function.vtu", fn2 = base_name + "_indexed.vtu";
+  test.check(compare_data<Grid>(fn1, fn2, "p", true), base_name + ": vertex values");
+  test.check(compare_data<Grid>(fn1, fn2, "v", true), base_name + ": vertex vectors");
+  test.check(compare_data<Grid>(fn1, fn2, "c", false), base_name + ": element values");
+}
+
+// Write the same fields by a writer with statically typed fields and by the default writer
+template <class GridView>
+void typed_test (TestSuite& test, GridView const& gridView, std::string const& base_name)
+{
+  auto f = Functions::makeAnalyticGridViewFunction([](auto const& x) { return x[0] + 2*x[1]; }, gridView);
+  auto v = Functions::makeAnalyticGridViewFunction([](auto const& x) { return x; }, gridView);
+
+  for (auto format : {Vtk::ASCII, Vtk::BINARY, Vtk::COMPRESSED}) {
+    std::string name = base_name + (format == Vtk::ASCII ? "_ascii" : format == Vtk::BINARY ? "_bin" : "_zlib");
+    {
+      VtkUnstructuredGridWriter<GridView> vtkWriter(gridView, format, Vtk::FLOAT64);
+      vtkWriter.addPointData(f, "p").addPointData(v, "v").addCellData(f, "c");
+      vtkWriter.write(name + "_untyped.vtu");
+    }
+    {
+      auto vtkWriter = makeVtkTypedWriter<VtkUnstructuredGridWriter<GridView>>(gridView,
+        std::make_tuple(Vtk::field(f, "p"), Vtk::field(v, "v")), std::make_tuple(Vtk::field(f, "c")),
+        format, Vtk::FLOAT64);
+      vtkWriter.write(name + "_typed.vtu");
+    }
+    test.check(compare_files(name + "_untyped.vtu", name + "_typed.vtu"), name + ": typed writer");
+  }
+}
+
+// Evaluate a discrete function by the stored shape function values and pointwise
+template <class Grid, class DataCollector, class GridView>
+void discrete_test (TestSuite& test, GridView const& gridView, std::string const& base_name)
+{
+#if DUNE_VERSION_LT(DUNE_FUNCTIONS, 2, 7)
+  using namespace Functions::BasisBuilder;
+#else
+  using namespace Functions::BasisFactory;
+#endif
+  auto basis = makeBasis(gridView, lagrange<2>());
+  std::vector<double> coefficients(basis.dimension());
+  Functions::interpolate(basis, coefficients, [](auto const& x) { return std::sin(x[0]) * std::exp(x[1]); });
+
+  auto u = Functions::makeDiscreteGlobalBasisFunction<double>(basis, coefficients);
+  LocalFunctionOnly<decltype(u)> w{u};
+  static_assert(Vtk::IsDiscreteScalarFunction<decltype(u),GridView>::value, "");
+  static_assert(!Vtk::IsDiscreteScalarFunction<decltype(w),GridView>::value, "");
+
+  for (bool tables : {false, true}) {
+    VtkUnstructuredGridWriter<GridView, DataCollector> vtkWriter(gridView, Vtk::BINARY, Vtk::FLOAT64);
+    if (tables)
+      vtkWriter.addPointData(u, "u").addCellData(u, "c");
+    else
+      vtkWriter.addPointData(w, "u").addCellData(w, "c");
+    vtkWriter.write(base_name + (tables ? "_tables.vtu" : "_pointwise.vtu"));
+  }
+
+  std::string fn1 = base_name + "_pointwise.vtu", fn2 = base_name + "_tables.vtu";
+  test.check(compare_data<Grid>(fn1, fn2, "u", true), base_name + ": point data of the shape value tables");
+  test.check(compare_data<Grid>(fn1, fn2, "c", false), base_name + ": cell data of the shape value tables");
+}
+
+// Compute fields from the arrays of other fields and by evaluating the same expressions
+template <class Grid, class GridView>
+void derived_test (TestSuite& test, GridView const& gridView, std::string const& base_name)
+{
+  auto f = Functions::makeAnalyticGridViewFunction([](auto const& x) { return x[0] + 2*x[1]; }, gridView);
+  auto q = Functions::makeAnalyticGridViewFunction([](auto const& x) { return x[1]; }, gridView);
+  auto v = Functions::makeAnalyticGridViewFunction([](auto const& x) { return x; }, gridView);
+  auto norm = Functions::makeAnalyticGridViewFunction([](auto const& x) { return x.two_norm(); }, gridView);
+  auto comb = Functions::makeAnalyticGridViewFunction([](auto const& x) { return 2*(x[0] + 2*x[1]) - x[1] + 1; }, gridView);
+
+  for (auto format : {Vtk::ASCII, Vtk::BINARY, Vtk::COMPRESSED}) {
+    std::string name = base_name + (format == Vtk::ASCII ? "_ascii" : format == Vtk::BINARY ? "_bin" : "_zlib");
+    {
+      VtkUnstructuredGridWriter<GridView> vtkWriter(gridView, format, Vtk::FLOAT64);
+      vtkWriter.addPointData(f, "p").addPointData(q, "q").addPointData(v, "v");
+      vtkWriter.addCellData(v, "w");
+      vtkWriter.addDerivedPointData(Vtk::magnitude("v"), "norm");
+      vtkWriter.addDerivedPointData(Vtk::linearCombination({{2.0, "p"}, {-1.0, "q"}}, 1.0), "comb");
+      vtkWriter.addDerivedCellData(Vtk::magnitude("w"), "norm");
+      vtkWriter.write(name + "_derived.vtu");
+    }
+    {
+      VtkUnstructuredGridWriter<GridView> vtkWriter(gridView, format, Vtk::FLOAT64);
+      vtkWriter.addPointData(norm, "norm").addPointData(comb, "comb");
+      vtkWriter.addCellData(norm, "norm");
+      vtkWriter.write(name + "_direct.vtu");
+    }
+
+    std::string fn1 = name + "_direct.vtu", fn2 = name + "_derived.vtu";
+    test.check(compare_data<Grid>(fn1, fn2, "norm", true), name + ": magnitude of point data");
+    test.check(compare_data<Grid>(fn1, fn2, "comb", true), name + ": linear combination of point data");
+    test.check(compare_data<Grid>(fn1, fn2, "norm", false), name + ": magnitude of cell data");
+  }
+}
+
+
+int main (int argc, char** argv)
+{
+  auto& mpi = Dune::MPIHelper::instance(argc, argv);
+  if (mpi.size() > 1) {
+    std::cout << "The fields are tested on a single rank\n";
+    return 0;
+  }
+
+  TestSuite test{};
+
+  using GridType = UGGrid<2>;
+  using GridView = typename GridType::LeafGridView;
+  FieldVector<double,2> lowerLeft; lowerLeft = 0.0;
+  FieldVector<double,2> upperRight; upperRight = 1.0;
+  auto numElements = filledArray<2,unsigned int>(8);
+  auto gridPtr = StructuredGridFactory<GridType>::createSimplexGrid(lowerLeft, upperRight, numElements);
+  GridView gridView = gridPtr->leafGridView();
+
+  fused_test<ContinuousDataCollector<GridView>>(test, gridView, "fields_test_fused_continuous");
+  fused_test<LagrangeDataCollector<GridView,2>>(test, gridView, "fields_test_fused_lagrange");
+  indexed_test<GridType>(test, gridView, "fields_test_indexed");
+  typed_test(test, gridView, "fields_test_typed");
+  discrete_test<GridType, ContinuousDataCollector<GridView>>(test, gridView, "fields_test_discrete_continuous");
+  discrete_test<GridType, LagrangeDataCollector<GridView,3>>(test, gridView, "fields_test_discrete_lagrange");
+  derived_test<GridType>(test, gridView, "fields_test_derived");
+
+  return test.exit();
+}
@@ -0,0 +1,113 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/parallel/mpihelper.hh> // An initializer of MPI
+#include <dune/common/filledarray.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/functions/gridfunctions/analyticgridviewfunction.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/vtk/writers/vtkunstructuredgridwriter.hh>
+#include <dune/vtk/datacollectors/continuousdatacollector.hh>
+#include <dune/vtk/datacollectors/lagrangedatacollector.hh>
+
+using namespace Dune;
+
+// see https://stackoverflow.com/questions/6163611/compare-two-files
+bool compare_files (std::string const& fn1, std::string const& fn2)
+{
+  std::ifstream in1(fn1, std::ios::binary);
+  std::ifstream in2(fn2, std::ios::binary);
+  if (!in1 || !in2) {
+    std::cout << "can not find file " << fn1 << " or file " << fn2 << "\n";
+    return false;
+  }
+
+  std::ifstream::pos_type size1 = in1.seekg(0, std::ifstream::end).tellg();
+  in1.seekg(0, std::ifstream::beg);
+
+  std::ifstream::pos_type size2 = in2.seekg(0, std::ifstream::end).tellg();
+  in2.seekg(0, std::ifstream::beg);
+
+  if (size1 != size2)
+    return false;
+
+  static const std::size_t BLOCKSIZE = 4096;
+  std::size_t remaining = size1;
+
+  while (remaining) {
+    char buffer1[BLOCKSIZE], buffer2[BLOCKSIZE];
+    std::size_t size = std::min(BLOCKSIZE, remaining);
+
+    in1.read(buffer1, size);
+    in2.read(buffer2, size);
+
+    if (0 != std::memcmp(buffer1, buffer2, size))
+      return false;
+
+    remaining -= size;
+  }
+
+  return true;
+}
+
+// Write the same data without threads and with 1 and 4 threads collecting the data
+template <class DataCollector, class GridView>
+void writer_test (TestSuite& test, GridView const& gridView, std::string const& base_name)
+{
+  auto f = Functions::makeAnalyticGridViewFunction([](auto const& x) { return x[0] + 2*x[1]; }, gridView);
+
+  std::vector<std::size_t> numThreads = {0, 1, 4};
+  for (std::size_t n : numThreads) {
+    VtkUnstructuredGridWriter<GridView, DataCollector> vtkWriter(gridView, Vtk::BINARY, Vtk::FLOAT64);
+    vtkWriter.addPointData(f, "p");
+    vtkWriter.addCellData(f, "c");
+    if (n > 0)
+      vtkWriter.setNumThreads(n).setThreadedCollection();
+    vtkWriter.write(base_name + "_t" + std::to_string(n) + ".vtu");
+  }
+
+  for (std::size_t n : numThreads)
+    test.check(compare_files(base_name + "_t0.vtu", base_name + "_t" + std::to_string(n) + ".vtu"),
+      base_name + ": output with " + std::to_string(n) + " threads");
+}
+
+
+template <int I>
+using int_ = std::integral_constant<int,I>;
+
+int main (int argc, char** argv)
+{
+  auto& mpi = Dune::MPIHelper::instance(argc, argv);
+  if (mpi.size() > 1) {
+    std::cout << "The threaded collection is tested on a single rank\n";
+    return 0;
+  }
+
+  TestSuite test{};
+
+  Hybrid::forEach(std::make_tuple(int_<2>{}, int_<3>{}), [&test](auto dim)
+  {
+    using GridType = YaspGrid<dim.value>;
+    using GridView = typename GridType::LeafGridView;
+    FieldVector<double,dim.value> upperRight; upperRight = 1.0;
+    auto numElements = filledArray<dim.value,int>(8);
+    GridType grid(upperRight, numElements);
+
+    std::string base_name = "threaded_collection_test_dim" + std::to_string(dim.value);
+    writer_test<ContinuousDataCollector<GridView>>(test, grid.leafGridView(), base_name + "_continuous");
+    writer_test<LagrangeDataCollector<GridView,2>>(test, grid.leafGridView(), base_name + "_lagrange");
+  });
+
+  return test.exit();
+}
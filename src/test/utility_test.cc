@@ -0,0 +1,246 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <locale>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh> // An initializer of MPI
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/vtk/vtktypes.hh>
+#include <dune/vtk/utility/charconv.hh>
+#include <dune/vtk/utility/lagrangepoints.hh>
+#include <dune/vtk/utility/threadpool.hh>
+#include <dune/vtk/utility/vertexwelder.hh>
+#include <dune/vtk/utility/xmltokenizer.hh>
+
+using namespace Dune;
+
+void weld_test (TestSuite& test)
+{
+  using Point = FieldVector<double,2>;
+  const double tol = 1.e-3;
+
+  // a chain of points closer than the tolerance, an isolated point, a pair of
+  // points around the center and an exact duplicate
+  std::vector<Point> points = {
+    {0.0, 0.0}, {0.6e-3, 0.0}, {1.0, 1.0}, {1.2e-3, 0.0}, {0.5, 0.5-0.4e-3}, {0.5, 0.5+0.4e-3}, {0.6e-3, 0.0}
+  };
+
+  auto welded = Vtk::weldPoints(points, tol);
+  test.check(welded.index == std::vector<std::size_t>{0,0,1,0,2,2,0}, "weldPoints: index of chained points");
+  test.check(welded.unique == std::vector<std::size_t>{0,2,4}, "weldPoints: unique points");
+
+  // with a small tolerance, only the exact duplicate is merged
+  auto unmerged = Vtk::weldPoints(points, 1.e-6);
+  test.check(unmerged.unique.size() == 6u, "weldPoints: tolerance smaller than the distances");
+
+  // many copies of a lattice, distributed over several blocks and threads
+  const int n = 50, copies = 3;
+  std::vector<Point> lattice;
+  for (int c = 0; c < copies; ++c)
+    for (int j = 0; j < n; ++j)
+      for (int i = 0; i < n; ++i)
+        lattice.push_back({i + c*0.1*tol, j - c*0.1*tol});
+
+  Vtk::ThreadPool pool(4);
+  auto result = Vtk::weldPoints(lattice, tol, pool);
+  test.check(result.unique.size() == std::size_t(n*n), "weldPoints: number of lattice points");
+
+  bool firstCopy = true;
+  for (std::size_t i = 0; i < lattice.size(); ++i)
+    firstCopy = firstCopy && result.unique[result.index[i]] == i % (n*n);
+  test.check(firstCopy, "weldPoints: points are mapped to the first copy");
+}
+
+
+void lagrange_test (TestSuite& test)
+{
+  using Nodes = std::vector<Vtk::LatticePoint>;
+
+  // VTK node ordering of the quadratic cells
+  test.check(Vtk::lagrangeNodes(Vtk::LAGRANGE_CURVE, 2) == Nodes{
+    {{0,0,0}}, {{2,0,0}}, {{1,0,0}}}, "lagrangeNodes: curve");
+  test.check(Vtk::lagrangeNodes(Vtk::LAGRANGE_TRIANGLE, 2) == Nodes{
+    {{0,0,0}}, {{2,0,0}}, {{0,2,0}}, {{1,0,0}}, {{1,1,0}}, {{0,1,0}}}, "lagrangeNodes: triangle");
+  test.check(Vtk::lagrangeNodes(Vtk::LAGRANGE_QUADRILATERAL, 2) == Nodes{
+    {{0,0,0}}, {{2,0,0}}, {{2,2,0}}, {{0,2,0}}, {{1,0,0}}, {{2,1,0}}, {{1,2,0}}, {{0,1,0}}, {{1,1,0}}},
+    "lagrangeNodes: quadrilateral");
+  test.check(Vtk::lagrangeNodes(Vtk::LAGRANGE_TETRAHEDRON, 2) == Nodes{
+    {{0,0,0}}, {{2,0,0}}, {{0,2,0}}, {{0,0,2}}, {{1,0,0}}, {{1,1,0}}, {{0,1,0}}, {{0,0,1}}, {{1,0,1}}, {{0,1,1}}},
+    "lagrangeNodes: tetrahedron");
+  test.check(Vtk::lagrangeNodes(Vtk::LAGRANGE_HEXAHEDRON, 2) == Nodes{
+    {{0,0,0}}, {{2,0,0}}, {{2,2,0}}, {{0,2,0}}, {{0,0,2}}, {{2,0,2}}, {{2,2,2}}, {{0,2,2}},
+    {{1,0,0}}, {{2,1,0}}, {{1,2,0}}, {{0,1,0}}, {{1,0,2}}, {{2,1,2}}, {{1,2,2}}, {{0,1,2}},
+    {{0,0,1}}, {{2,0,1}}, {{0,2,1}}, {{2,2,1}},
+    {{0,1,1}}, {{2,1,1}}, {{1,0,1}}, {{1,2,1}}, {{1,1,0}}, {{1,1,2}}, {{1,1,1}}},
+    "lagrangeNodes: hexahedron");
+  test.check(Vtk::lagrangeNodes(Vtk::LAGRANGE_WEDGE, 2) == Nodes{
+    {{0,0,0}}, {{2,0,0}}, {{0,2,0}}, {{0,0,2}}, {{2,0,2}}, {{0,2,2}},
+    {{1,0,0}}, {{1,1,0}}, {{0,1,0}}, {{1,0,2}}, {{1,1,2}}, {{0,1,2}},
+    {{0,0,1}}, {{2,0,1}}, {{0,2,1}}, {{1,0,1}}, {{1,1,1}}, {{0,1,1}}},
+    "lagrangeNodes: wedge");
+
+  // number of distinct nodes of higher order cells
+  for (int p = 1; p <= 5; ++p) {
+    auto count = [p](std::uint8_t type) {
+      auto nodes = Vtk::lagrangeNodes(type, p);
+      std::set<Vtk::LatticePoint> distinct(nodes.begin(), nodes.end());
+      return distinct.size() == nodes.size() ? nodes.size() : 0u;
+    };
+    std::size_t q = p;
+    test.check(count(Vtk::LAGRANGE_CURVE) == q+1, "lagrangeNodes: curve of order " + std::to_string(p));
+    test.check(count(Vtk::LAGRANGE_TRIANGLE) == (q+1)*(q+2)/2, "lagrangeNodes: triangle of order " + std::to_string(p));
+    test.check(count(Vtk::LAGRANGE_QUADRILATERAL) == (q+1)*(q+1), "lagrangeNodes: quadrilateral of order " + std::to_string(p));
+    test.check(count(Vtk::LAGRANGE_TETRAHEDRON) == (q+1)*(q+2)*(q+3)/6, "lagrangeNodes: tetrahedron of order " + std::to_string(p));
+    test.check(count(Vtk::LAGRANGE_HEXAHEDRON) == (q+1)*(q+1)*(q+1), "lagrangeNodes: hexahedron of order " + std::to_string(p));
+    test.check(count(Vtk::LAGRANGE_WEDGE) == (q+1)*(q+2)/2*(q+1), "lagrangeNodes: wedge of order " + std::to_string(p));
+  }
+
+  // Lagrange pyramids are not supported
+  bool thrown = false;
+  try {
+    Vtk::lagrangeNodes(std::uint8_t(74), 2);
+  } catch (NotImplemented const&) {
+    thrown = true;
+  }
+  test.check(thrown, "lagrangeNodes: pyramid throws NotImplemented");
+}
+
+
+void tokenizer_test (TestSuite& test)
+{
+  std::string raw = "\x01<\x02>_\x03";
+  std::string xml =
+    "<?xml version=\"1.0\"?>\n"
+    "<!-- comment with <tags> -->\n"
+    "<VTKFile type=\"UnstructuredGrid\"\n"
+    "         byte_order='LittleEndian'><Piece NumberOfPoints=\"4\"\n"
+    "  NumberOfCells=\"1\"/><DataArray Name=\"u\" format=\"ascii\">1 2 3</DataArray>\n"
+    "<AppendedData encoding=\"raw\">\n"
+    "  _" + raw;
+  std::size_t rawPosition = xml.size() - raw.size();
+  std::size_t textPosition = xml.find("1 2 3");
+
+  // use a small buffer, such that the tags are split over several blocks
+  std::istringstream input(xml);
+  Vtk::XmlTokenizer tokenizer(input, 16);
+  Vtk::XmlTag tag;
+
+  test.check(tokenizer.next(tag) && tag.name == "VTKFile" && !tag.closing, "XmlTokenizer: <VTKFile>");
+  test.check(tag.attribute("byte_order") == "LittleEndian", "XmlTokenizer: attribute in single quotes");
+
+  test.check(tokenizer.next(tag) && tag.name == "Piece" && tag.selfClosing, "XmlTokenizer: self-closing <Piece/>");
+  test.check(tag.attribute("NumberOfCells") == "1", "XmlTokenizer: attribute on the next line");
+  test.check(tokenizer.next(tag) && tag.name == "Piece" && tag.closing, "XmlTokenizer: </Piece> of self-closing tag");
+
+  test.check(tokenizer.next(tag) && tag.name == "DataArray" && !tag.selfClosing, "XmlTokenizer: <DataArray>");
+  test.check(tokenizer.position() == textPosition, "XmlTokenizer: position of the DataArray text");
+  std::string text;
+  tokenizer.readText(text);
+  test.check(text == "1 2 3", "XmlTokenizer: DataArray text");
+  test.check(tokenizer.next(tag) && tag.name == "DataArray" && tag.closing, "XmlTokenizer: </DataArray>");
+
+  test.check(tokenizer.next(tag) && tag.name == "AppendedData", "XmlTokenizer: <AppendedData>");
+  test.check(tokenizer.appendedDataPosition() == rawPosition, "XmlTokenizer: offset of the appended data");
+}
+
+
+// The values formatted by formatValues are the same as written by the classic-locale stream
+template <class T>
+bool same_as_stream (std::vector<T> const& values, int precision)
+{
+  std::string buffer;
+  Vtk::formatValues(buffer, values.data(), values.size(), precision, 4);
+
+  std::ostringstream out;
+  out.imbue(std::locale::classic());
+  out.precision(precision);
+  for (std::size_t i = 0; i < values.size(); ++i)
+    out << +values[i] << ((i+1) % 4 != 0 ? ' ' : '\n');
+  return buffer == out.str();
+}
+
+void format_test (TestSuite& test)
+{
+  std::vector<double> doubles = {0.0, -1.0, 0.1, 1.0/3.0, 1.e-300, -2.5e17, std::numeric_limits<double>::max()};
+  std::vector<float> floats = {0.0f, -1.0f, 0.1f, 1.0f/3.0f, 1.e-30f, 7.25e9f};
+  std::vector<std::int64_t> ints = {0, -1, 42, std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max()};
+  std::vector<std::uint8_t> bytes = {0, 1, 12, 255};
+
+  test.check(same_as_stream(doubles, std::numeric_limits<double>::max_digits10), "formatValues: double");
+  test.check(same_as_stream(doubles, 8), "formatValues: double with 8 digits");
+  test.check(same_as_stream(floats, std::numeric_limits<float>::max_digits10), "formatValues: float");
+  test.check(same_as_stream(ints, 0), "formatValues: int64");
+  test.check(same_as_stream(bytes, 0), "formatValues: uint8 as numbers");
+}
+
+
+template <class T>
+bool round_trip (std::vector<T> const& values, int precision)
+{
+  std::string buffer;
+  Vtk::formatValues(buffer, values.data(), values.size(), precision);
+
+  std::vector<T> parsed;
+  Vtk::parseValues(buffer.data(), buffer.data() + buffer.size(), parsed);
+  return parsed == values;
+}
+
+void parse_test (TestSuite& test)
+{
+  std::vector<double> doubles = {0.0, -1.0, 0.1, 1.0/3.0, 1.e-300, -2.5e17, std::numeric_limits<double>::max()};
+  std::vector<float> floats = {0.0f, -1.0f, 0.1f, 1.0f/3.0f, 1.e-30f, 7.25e9f};
+  std::vector<std::int64_t> ints = {0, -1, 42, std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max()};
+  std::vector<std::uint8_t> bytes = {0, 1, 12, 255};
+
+  test.check(round_trip(doubles, std::numeric_limits<double>::max_digits10), "formatValues/parseValues: double");
+  test.check(round_trip(floats, std::numeric_limits<float>::max_digits10), "formatValues/parseValues: float");
+  test.check(round_trip(ints, 0), "formatValues/parseValues: int64");
+  test.check(round_trip(bytes, 0), "formatValues/parseValues: uint8");
+
+  // values separated by arbitrary whitespace
+  std::string text = " 1\t2\n\n 3  ";
+  std::vector<int> values;
+  Vtk::parseValues(text.data(), text.data() + text.size(), values);
+  test.check(values == std::vector<int>{1,2,3}, "parseValues: whitespace");
+
+  // invalid values throw an IOError with their position
+  std::string invalid = "1.0 2.0 x3 4.0";
+  std::vector<double> parsed;
+  std::string message;
+  try {
+    Vtk::parseValues(invalid.data(), invalid.data() + invalid.size(), parsed, 100);
+  } catch (IOError const& e) {
+    message = e.what();
+  }
+  test.check(message.find("'x3'") != std::string::npos, "parseValues: IOError names the invalid value");
+  test.check(message.find("offset 108") != std::string::npos, "parseValues: IOError reports the offset");
+}
+
+
+int main (int argc, char** argv)
+{
+  Dune::MPIHelper::instance(argc, argv);
+
+  TestSuite test{};
+  weld_test(test);
+  lagrange_test(test);
+  tokenizer_test(test);
+  format_test(test);
+  parse_test(test);
+
+  return test.exit();
+}
@@ -0,0 +1,287 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <regex>
+#include <set>
+#include <vector>
+
+#include <dune/common/parallel/mpihelper.hh> // An initializer of MPI
+#include <dune/common/filledarray.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/functions/gridfunctions/analyticgridviewfunction.hh>
+#include <dune/grid/uggrid.hh>
+#include <dune/grid/utility/structuredgridfactory.hh>
+
+#include <dune/vtk/vtkreader.hh>
+#include <dune/vtk/writers/vtkunstructuredgridwriter.hh>
+#include <dune/vtk/gridcreators/continuousgridcreator.hh>
+
+using namespace Dune;
+
+// see https://stackoverflow.com/questions/6163611/compare-two-files
+bool compare_files (std::string const& fn1, std::string const& fn2)
+{
+  std::ifstream in1(fn1, std::ios::binary);
+  std::ifstream in2(fn2, std::ios::binary);
+  if (!in1 || !in2) {
+    std::cout << "can not find file " << fn1 << " or file " << fn2 << "\n";
+    return false;
+  }
+
+  std::ifstream::pos_type size1 = in1.seekg(0, std::ifstream::end).tellg();
+  in1.seekg(0, std::ifstream::beg);
+
+  std::ifstream::pos_type size2 = in2.seekg(0, std::ifstream::end).tellg();
+  in2.seekg(0, std::ifstream::beg);
+
+  if (size1 != size2)
+    return false;
+
+  static const std::size_t BLOCKSIZE = 4096;
+  std::size_t remaining = size1;
+
+  while (remaining) {
+    char buffer1[BLOCKSIZE], buffer2[BLOCKSIZE];
+    std::size_t size = std::min(BLOCKSIZE, remaining);
+
+    in1.read(buffer1, size);
+    in2.read(buffer2, size);
+
+    if (0 != std::memcmp(buffer1, buffer2, size))
+      return false;
+
+    remaining -= size;
+  }
+
+  return true;
+}
+
+using TestCases = std::set<std::tuple<std::string,Vtk::FormatTypes,Vtk::DataTypes>>;
+static TestCases test_cases = {
+  {"ascii32", Vtk::ASCII, Vtk::FLOAT32},
+  {"bin32", Vtk::BINARY, Vtk::FLOAT32},
+  {"zlib32", Vtk::COMPRESSED, Vtk::FLOAT32},
+  {"ascii64", Vtk::ASCII, Vtk::FLOAT64},
+  {"bin64", Vtk::BINARY, Vtk::FLOAT64},
+  {"zlib64", Vtk::COMPRESSED, Vtk::FLOAT64},
+};
+
+// Split the .vtu file `filename` into its <Piece> elements, without the offsets of the
+// appended arrays, and the raw appended data
+void split_file (std::string const& filename, std::vector<std::string>& pieces, std::string& appended)
+{
+  std::ifstream in(filename, std::ios::binary);
+  std::string content{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+
+  std::size_t end = content.find("<AppendedData");
+  appended.clear();
+  if (end != std::string::npos) {
+    std::size_t first = content.find('_', end) + 1;
+    appended = content.substr(first, content.rfind("</AppendedData>") - first);
+  }
+
+  std::string xml = content.substr(0, end);
+  std::regex offset{" offset=\"[0-9]+\" *"};
+  pieces.clear();
+  for (std::size_t pos = xml.find("<Piece"); pos != std::string::npos; pos = xml.find("<Piece", pos)) {
+    std::size_t next = xml.find("</Piece>", pos) + 8;
+    pieces.push_back(std::regex_replace(xml.substr(pos, next - pos), offset, ""));
+    pos = next;
+  }
+}
+
+// Modes of writing the same data: default, sequential, asynchronous, aggregated on one rank,
+// and collective into one file
+static std::vector<std::string> write_modes = {"default", "sequential", "async", "aggregated", "collective"};
+
+template <class GridView, class TestCase>
+void writer_test (GridView const& gridView, TestCase const& test_case, std::string const& base_name)
+{
+  auto f = Functions::makeAnalyticGridViewFunction([](auto const& x) { return x[0] + 2*x[1]; }, gridView);
+
+  for (auto const& mode : write_modes) {
+    VtkUnstructuredGridWriter<GridView> vtkWriter(gridView, std::get<1>(test_case), std::get<2>(test_case));
+    vtkWriter.addPointData(f, "p");
+    vtkWriter.addCellData(f, "c");
+    if (mode == "sequential")
+      vtkWriter.setSequential();
+    else if (mode == "aggregated")
+      vtkWriter.setNumAggregators(1);
+
+    std::string filename = base_name + "_" + mode + ".vtu";
+    if (mode == "async")
+      vtkWriter.writeAsync(filename).get();
+    else if (mode == "collective")
+      vtkWriter.writeCollective(filename);
+    else
+      vtkWriter.write(filename);
+  }
+}
+
+// Read the pieces of the file `filename` and concatenate their point and cell data
+template <class Grid>
+std::vector<std::string> read_pieces (std::string const& filename,
+                                      std::vector<double>& pointData, std::vector<double>& cellData,
+                                      bool memoryMapping = true)
+{
+  std::vector<std::string> pieces;
+  {
+    GridFactory<Grid> factory;
+    VtkReader<Grid> reader{factory};
+    reader.readFromFile(filename, false);
+    pieces = reader.pieces();
+  }
+
+  pointData.clear();
+  cellData.clear();
+  for (auto const& piece : pieces) {
+    GridFactory<Grid> factory;
+    VtkReader<Grid> reader{factory};
+    reader.setMemoryMapping(memoryMapping);
+    reader.readFromFile(piece, false);
+
+    auto p = reader.template pointData<double>("p");
+    auto c = reader.template cellData<double>("c");
+    pointData.insert(pointData.end(), p.begin(), p.end());
+    cellData.insert(cellData.end(), c.begin(), c.end());
+  }
+  return pieces;
+}
+
+template <class Grid>
+void reader_test (MPIHelper& mpi, TestSuite& test, std::string const& base_name)
+{
+  std::string ext = ".vtu";
+  if (mpi.size() > 1)
+    ext = ".pvtu";
+
+  std::vector<double> pointData, cellData;
+  auto pieces = read_pieces<Grid>(base_name + "_default" + ext, pointData, cellData);
+  test.check(!pointData.empty() && !cellData.empty(), base_name + ": data is read");
+
+  // the appended data read through the stream equals the data read from the memory mapping
+  std::vector<double> streamPointData, streamCellData;
+  read_pieces<Grid>(base_name + "_default" + ext, streamPointData, streamCellData, false);
+  test.check(streamPointData == pointData, base_name + ": point data read without memory mapping");
+  test.check(streamCellData == cellData, base_name + ": cell data read without memory mapping");
+
+  for (auto const& mode : write_modes) {
+    if (mode == "collective") {
+      // the collective file contains the pieces of all ranks and their appended data, in
+      // the order of the ranks
+      std::vector<std::string> collectivePieces, modePieces, filePieces;
+      std::string collectiveAppended, modeAppended, fileAppended;
+      split_file(base_name + "_" + mode + ".vtu", collectivePieces, collectiveAppended);
+      for (auto const& piece : pieces) {
+        split_file(piece, filePieces, fileAppended);
+        modePieces.insert(modePieces.end(), filePieces.begin(), filePieces.end());
+        modeAppended += fileAppended;
+      }
+      test.check(collectivePieces == modePieces, base_name + "_" + mode + ": pieces");
+      test.check(collectiveAppended == modeAppended, base_name + "_" + mode + ": appended data");
+      continue;
+    }
+
+    std::vector<double> modePointData, modeCellData;
+    auto modePieces = read_pieces<Grid>(base_name + "_" + mode + ext, modePointData, modeCellData);
+    test.check(modePointData == pointData, base_name + "_" + mode + ": point data");
+    test.check(modeCellData == cellData, base_name + "_" + mode + ": cell data");
+
+    if (mode == "aggregated") {
+      test.check(modePieces.size() == 1u, base_name + "_" + mode + ": one merged piece");
+    } else {
+      // the sequential and asynchronous writers produce the same pieces
+      test.check(modePieces.size() == pieces.size(), base_name + "_" + mode + ": number of pieces");
+      for (std::size_t i = 0; i < std::min(pieces.size(), modePieces.size()); ++i)
+        test.check(compare_files(pieces[i], modePieces[i]), "compare(" + pieces[i] + ", " + modePieces[i] + ")");
+    }
+  }
+}
+
+// Write the grid twice with the mesh cache, refine it and write it twice again. All files must
+// be equal to the files written without the cache.
+template <class Grid>
+void mesh_cache_test (MPIHelper& mpi, TestSuite& test, Grid& grid, std::string const& base_name)
+{
+  using GridView = typename Grid::LeafGridView;
+  GridView gridView = grid.leafGridView();
+  auto f = Functions::makeAnalyticGridViewFunction([](auto const& x) { return x[0] + 2*x[1]; }, gridView);
+
+  VtkUnstructuredGridWriter<GridView> cachedWriter(gridView, Vtk::COMPRESSED, Vtk::FLOAT64);
+  cachedWriter.addPointData(f, "p");
+  cachedWriter.addCellData(f, "c");
+  cachedWriter.setMeshCaching();
+
+  std::string ext = mpi.size() > 1 ? ".pvtu" : ".vtu";
+  for (int level = 0; level < 2; ++level) {
+    std::string name = base_name + "_level" + std::to_string(level);
+    {
+      VtkUnstructuredGridWriter<GridView> vtkWriter(gridView, Vtk::COMPRESSED, Vtk::FLOAT64);
+      vtkWriter.addPointData(f, "p");
+      vtkWriter.addCellData(f, "c");
+      vtkWriter.write(name + "_uncached.vtu");
+    }
+    cachedWriter.write(name + "_cached0.vtu"); // fills the cache, or detects the refinement
+    cachedWriter.write(name + "_cached1.vtu"); // copies the mesh arrays from the cache
+    mpi.getCollectiveCommunication().barrier();
+
+    std::vector<double> pointData, cellData;
+    auto pieces = read_pieces<Grid>(name + "_uncached" + ext, pointData, cellData);
+    for (std::string cached : {"_cached0", "_cached1"}) {
+      auto cachedPieces = read_pieces<Grid>(name + cached + ext, pointData, cellData);
+      test.check(cachedPieces.size() == pieces.size(), name + cached + ": number of pieces");
+      for (std::size_t i = 0; i < std::min(pieces.size(), cachedPieces.size()); ++i)
+        test.check(compare_files(pieces[i], cachedPieces[i]), "compare(" + pieces[i] + ", " + cachedPieces[i] + ")");
+    }
+    mpi.getCollectiveCommunication().barrier();
+
+    grid.globalRefine(1);
+    grid.loadBalance();
+  }
+}
+
+
+template <int I>
+using int_ = std::integral_constant<int,I>;
+
+int main (int argc, char** argv)
+{
+  auto& mpi = Dune::MPIHelper::instance(argc, argv);
+
+  TestSuite test{};
+
+  Hybrid::forEach(std::make_tuple(int_<2>{}, int_<3>{}), [&test,&mpi](auto dim)
+  {
+    using GridType = UGGrid<dim.value>;
+    FieldVector<double,dim.value> lowerLeft; lowerLeft = 0.0;
+    FieldVector<double,dim.value> upperRight; upperRight = 1.0;
+    auto numElements = filledArray<dim.value,unsigned int>(4);
+    auto gridPtr = StructuredGridFactory<GridType>::createSimplexGrid(lowerLeft, upperRight, numElements);
+    gridPtr->loadBalance();
+
+    for (auto const& test_case : test_cases) {
+      // the test runs with several numbers of ranks, so these must not write the same files
+      std::string base_name = "write_modes_test_np" + std::to_string(mpi.size())
+        + "_dim" + std::to_string(dim.value) + "_" + std::get<0>(test_case);
+      writer_test(gridPtr->leafGridView(), test_case, base_name);
+      mpi.getCollectiveCommunication().barrier(); // need a barrier between write and read
+
+      reader_test<GridType>(mpi, test, base_name);
+      mpi.getCollectiveCommunication().barrier();
+    }
+
+    mesh_cache_test(mpi, test, *gridPtr, "write_modes_test_np" + std::to_string(mpi.size())
+      + "_dim" + std::to_string(dim.value) + "_cache");
+  });
+
+  return test.exit();
+}
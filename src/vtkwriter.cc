@@ -20,6 +20,7 @@
 #include <dune/grid/uggrid.hh>
 #include <dune/grid/yaspgrid.hh>
 
+#include <dune/vtk/vtktypedwriter.hh>
 #include <dune/vtk/vtkwriter.hh>
 
 using namespace Dune;
@@ -66,7 +67,16 @@ void write (std::string prefix, GridView const& gridView)
     vtkWriter.addCellData(p1Interpol, "p0");
     vtkWriter.addPointData(p1Analytic, "q1");
     vtkWriter.addCellData(p1Analytic, "q0");
+    vtkWriter.addPointData(vec, "p1_vec"); // P1 coefficients are indexed by the vertex index
+    vtkWriter.addDerivedPointData(Vtk::linearCombination({{1.0, "p1"}, {-1.0, "q1"}}), "p1_error");
     vtkWriter.write(prefix + "_" + std::to_string(GridView::dimensionworld) + "d_" + std::get<0>(test_case) + ".vtu");
+
+    // the same fields, evaluated without type erasure
+    auto typedWriter = makeVtkTypedWriter<VtkUnstructuredGridWriter<GridView>>(gridView,
+      std::make_tuple(Vtk::field(p1Interpol, "p1"), Vtk::field(p1Analytic, "q1")),
+      std::make_tuple(Vtk::field(p1Interpol, "p0"), Vtk::field(p1Analytic, "q0")),
+      std::get<1>(test_case), std::get<2>(test_case));
+    typedWriter.write(prefix + "_typed_" + std::to_string(GridView::dimensionworld) + "d_" + std::get<0>(test_case) + ".vtu");
   }
 }
 